@@ -0,0 +1,42 @@
+import 'package:godot_dart/godot_dart.dart';
+
+/// Microbenchmark for RefCounted bindings crossing between strong and weak.
+///
+/// Dart holds one reference to a Resource, so every extra `reference` takes
+/// the refcount from 1 to 2 (the binding becomes strong) and every
+/// `unreference` takes it back (the binding becomes weak). Neither should
+/// create or delete persistent handles, which the handle monitors confirm.
+///
+/// Run the example with `GODOT_DART_BENCH=1` set to print the results.
+void runRefToggleBenchmark({int iterations = 1000000}) {
+  final performance = Performance.singleton;
+  final persistentHandles = StringName.fromString('GodotDart/Persistent Handles');
+  final weakHandles = StringName.fromString('GodotDart/Weak Persistent Handles');
+
+  int handleCount() =>
+      performance.getCustomMonitor(persistentHandles).cast<int>() +
+      performance.getCustomMonitor(weakHandles).cast<int>();
+
+  final resource = Resource();
+
+  // Warm up so the first crossing's setup isn't measured
+  for (int i = 0; i < 1000; ++i) {
+    resource.reference();
+    resource.unreference();
+  }
+
+  final handlesBefore = handleCount();
+  final stopwatch = Stopwatch()..start();
+  for (int i = 0; i < iterations; ++i) {
+    resource.reference();
+    resource.unreference();
+  }
+  stopwatch.stop();
+  final handlesAfter = handleCount();
+
+  final nsPerToggle = stopwatch.elapsedMicroseconds * 1000 / (iterations * 2);
+  print('RefCounted strong/weak toggle: $iterations round trips in '
+      '${stopwatch.elapsedMilliseconds}ms '
+      '(${nsPerToggle.toStringAsFixed(1)}ns per toggle)');
+  print('Persistent handles before: $handlesBefore, after: $handlesAfter');
+}
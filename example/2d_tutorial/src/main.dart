@@ -1,6 +1,9 @@
+import 'dart:io';
+
 import 'package:godot_dart/godot_dart.dart';
 
 import 'godot_dart_scripts.g.dart';
+import 'lib/ref_toggle_benchmark.dart';
 
 class SimpleTestNode extends Node {
   static final sTypeInfo = ExtensionTypeInfo<SimpleTestNode>(
@@ -40,6 +43,10 @@ void main() {
   refreshScripts();
 
   SimpleTestNode.bind(gde.typeResolver);
+
+  if (Platform.environment.containsKey('GODOT_DART_BENCH')) {
+    runRefToggleBenchmark();
+  }
 }
 
 @pragma('vm:entry-point')
@@ -0,0 +1,218 @@
+#include "crossing_trace.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <dart_tools_api.h>
+#include <godot_cpp/classes/file_access.hpp>
+
+#include "dart_bindings.h"
+#include "dart_helpers.h"
+
+std::atomic<uint8_t> CrossingTrace::s_flags = 0;
+
+CrossingTrace *CrossingTrace::instance() {
+  static CrossingTrace trace;
+  return &trace;
+}
+
+const char *CrossingTrace::get_kind_name(CrossingKind kind) {
+  switch (kind) {
+  case CrossingKind::EnterIsolate:
+    return "Enter Isolate";
+  case CrossingKind::MethodCall:
+    return "Method Call";
+  case CrossingKind::VirtualCall:
+    return "Virtual Call";
+  case CrossingKind::ScriptCall:
+    return "Script Call";
+  case CrossingKind::ScriptGet:
+    return "Script Get";
+  case CrossingKind::ScriptSet:
+    return "Script Set";
+  case CrossingKind::Signal:
+    return "Signal";
+  case CrossingKind::RefChange:
+    return "Ref Change";
+  case CrossingKind::ObjectCreation:
+    return "Object Creation";
+  case CrossingKind::Finalizer:
+    return "Finalizer";
+  default:
+    return "Unknown";
+  }
+}
+
+std::string CrossingTrace::get_dart_name(Dart_Handle object) {
+  const char *name = nullptr;
+  Dart_Handle dart_name = Dart_GetField(object, Dart_NewStringFromCString("name"));
+  if (Dart_IsError(dart_name) || Dart_IsError(Dart_StringToCString(dart_name, &name))) {
+    return std::string();
+  }
+  return std::string(name);
+}
+
+uint32_t CrossingTrace::current_thread_id() {
+  static std::atomic<uint32_t> next_thread_id = 1;
+  static thread_local uint32_t thread_id = next_thread_id.fetch_add(1, std::memory_order_relaxed);
+  return thread_id;
+}
+
+void CrossingTrace::start(size_t capacity) {
+  if (is_enabled()) {
+    return;
+  }
+
+  _events.assign(std::max<size_t>(capacity, 1), Event{});
+  _next_event = 0;
+  _main_thread_id = current_thread_id();
+  s_flags.fetch_or(kTraceFlag);
+}
+
+void CrossingTrace::stop() {
+  s_flags.fetch_and(static_cast<uint8_t>(~kTraceFlag));
+}
+
+void CrossingTrace::set_frame_stats_enabled(bool enabled) {
+  if (enabled) {
+    s_flags.fetch_or(kFrameStatsFlag);
+  } else {
+    s_flags.fetch_and(static_cast<uint8_t>(~kFrameStatsFlag));
+  }
+}
+
+uint32_t CrossingTrace::intern_name(const std::string &name) {
+  std::lock_guard<std::mutex> lock(_names_lock);
+  auto itr = _named_ids.find(name);
+  if (itr != _named_ids.end()) {
+    return itr->second;
+  }
+  uint32_t id = static_cast<uint32_t>(_names.size());
+  _names.push_back(name);
+  _named_ids.emplace(name, id);
+  return id;
+}
+
+void CrossingTrace::record(CrossingKind kind, uint32_t name_id, int64_t start_usec, int64_t end_usec) {
+  if (_events.empty()) {
+    return;
+  }
+
+  uint64_t index = _next_event.fetch_add(1, std::memory_order_relaxed) % _events.size();
+  Event &event = _events[index];
+  event.start_usec = start_usec;
+  event.duration_usec = end_usec - start_usec;
+  event.name_id = name_id;
+  event.thread_id = current_thread_id();
+  event.kind = kind;
+}
+
+static void append_json_string(std::string &out, const std::string &value) {
+  out += '"';
+  for (char c : value) {
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char escaped[8];
+        snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        out += escaped;
+      } else {
+        out += c;
+      }
+    }
+  }
+  out += '"';
+}
+
+bool CrossingTrace::dump(const godot::String &path) {
+  if (_events.empty()) {
+    GD_PRINT_WARNING("GodotDart: No crossings have been traced. Enable dart/runtime/trace_crossings to record them.");
+    return false;
+  }
+
+  godot::Ref<godot::FileAccess> file = godot::FileAccess::open(path, godot::FileAccess::WRITE);
+  if (file.is_null()) {
+    godot::String message = godot::String("GodotDart: Could not open ") + path + " to write the crossing trace";
+    GD_PRINT_ERROR(message.utf8().get_data());
+    return false;
+  }
+
+  std::vector<std::string> names;
+  {
+    std::lock_guard<std::mutex> lock(_names_lock);
+    names = _names;
+  }
+
+  std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  char buffer[128];
+  snprintf(buffer, sizeof(buffer),
+           "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Main Thread\"}}",
+           _main_thread_id);
+  out += buffer;
+
+  // Once the buffer has wrapped, the oldest event is the next to be written
+  uint64_t next_event = _next_event.load(std::memory_order_relaxed);
+  uint64_t count = std::min<uint64_t>(next_event, _events.size());
+  uint64_t first = next_event > _events.size() ? next_event % _events.size() : 0;
+  for (uint64_t i = 0; i < count; ++i) {
+    const Event &event = _events[(first + i) % _events.size()];
+    const char *kind_name = get_kind_name(event.kind);
+
+    out += ",{\"name\":";
+    if (event.name_id != 0 && event.name_id < names.size()) {
+      append_json_string(out, names[event.name_id]);
+    } else {
+      append_json_string(out, kind_name);
+    }
+    out += ",\"cat\":";
+    append_json_string(out, kind_name);
+    snprintf(buffer, sizeof(buffer), ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%lld,\"dur\":%lld}", event.thread_id,
+             static_cast<long long>(event.start_usec), static_cast<long long>(event.duration_usec));
+    out += buffer;
+
+    if (out.size() > 64 * 1024) {
+      file->store_string(godot::String::utf8(out.c_str(), static_cast<int64_t>(out.size())));
+      out.clear();
+    }
+  }
+  out += "]}\n";
+  file->store_string(godot::String::utf8(out.c_str(), static_cast<int64_t>(out.size())));
+  file->close();
+
+  return true;
+}
+
+CrossingTraceScope::CrossingTraceScope(CrossingKind kind, const godot::StringName &name)
+    : _kind(kind), _name_id(0), _start_usec(-1) {
+  if (CrossingTrace::is_enabled()) {
+    // A StringName is a pointer to its shared data, which is the same for
+    // every copy of the name
+    const void *key = *reinterpret_cast<const void *const *>(name._native_ptr());
+    _name_id =
+        CrossingTrace::instance()->intern(key, [&] { return std::string(godot::String(name).utf8().get_data()); });
+  }
+  if (CrossingTrace::is_recording()) {
+    start();
+  }
+}
+
+void CrossingTraceScope::start() {
+  _start_usec = Dart_TimelineGetMicros();
+}
+
+void CrossingTraceScope::finish() {
+  int64_t end_usec = Dart_TimelineGetMicros();
+  GodotDartBindings *bindings = GodotDartBindings::instance();
+  if (bindings != nullptr && CrossingTrace::are_frame_stats_enabled()) {
+    bindings->record_crossing(_kind, end_usec - _start_usec);
+  }
+  if (CrossingTrace::is_enabled()) {
+    CrossingTrace::instance()->record(_kind, _name_id, _start_usec, end_usec);
+  }
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dart_api.h>
+#include <godot_cpp/variant/string.hpp>
+#include <godot_cpp/variant/string_name.hpp>
+
+// The kinds of calls that cross between Godot and Dart
+enum class CrossingKind : uint8_t {
+  // Entering the isolate from another thread through execute_on_dart_thread,
+  // including the wait for the isolate lock
+  EnterIsolate,
+  MethodCall,
+  VirtualCall,
+  ScriptCall,
+  ScriptGet,
+  ScriptSet,
+  Signal,
+  // A RefCounted binding switching between a strong and weak handle
+  RefChange,
+  // Creating the Dart object for a Godot object or extension class
+  ObjectCreation,
+  Finalizer,
+
+  Count,
+};
+
+// An opt-in recorder for Godot <-> Dart crossings, enabled with the
+// "dart/runtime/trace_crossings" project setting. Each crossing is recorded
+// with its name and duration into a fixed size ring buffer, so only the most
+// recent events are kept, and can be written out as a Chrome trace
+// (chrome://tracing or https://ui.perfetto.dev).
+//
+// Crossings can also be totalled per frame in GodotDartBindings (see
+// record_crossing), enabled by "dart/runtime/crossing_stats" in debug builds.
+// With both disabled, a crossing costs a single relaxed atomic load.
+class CrossingTrace {
+public:
+  static const size_t kDefaultCapacity = 256 * 1024;
+
+  static CrossingTrace *instance();
+
+  static bool is_enabled() {
+    return (s_flags.load(std::memory_order_relaxed) & kTraceFlag) != 0;
+  }
+  static bool are_frame_stats_enabled() {
+    return (s_flags.load(std::memory_order_relaxed) & kFrameStatsFlag) != 0;
+  }
+  // True if crossings need to be timed at all
+  static bool is_recording() {
+    return s_flags.load(std::memory_order_relaxed) != 0;
+  }
+  static void set_frame_stats_enabled(bool enabled);
+  static const char *get_kind_name(CrossingKind kind);
+  // The `name` field of a Dart object, such as a MethodInfo or
+  // SignalCallable. Must be called from the Dart thread.
+  static std::string get_dart_name(Dart_Handle object);
+
+  // Must be called from the main thread, which is named in the trace
+  void start(size_t capacity = kDefaultCapacity);
+  // Stops recording. Recorded events are kept until the next start.
+  void stop();
+
+  // Returns an id for the name associated with `key`, calling `get_name` to
+  // find it the first time `key` is seen. Keys are compared by address.
+  template <typename F>
+  uint32_t intern(const void *key, F get_name) {
+    {
+      std::lock_guard<std::mutex> lock(_names_lock);
+      auto itr = _name_ids.find(key);
+      if (itr != _name_ids.end()) {
+        return itr->second;
+      }
+    }
+
+    // Finding the name may call into Dart, so it isn't done under the lock
+    std::string name = get_name();
+    std::lock_guard<std::mutex> lock(_names_lock);
+    auto itr = _name_ids.find(key);
+    if (itr != _name_ids.end()) {
+      return itr->second;
+    }
+    uint32_t id = static_cast<uint32_t>(_names.size());
+    _names.push_back(std::move(name));
+    _name_ids.emplace(key, id);
+    return id;
+  }
+
+  // Returns an id for `name`, for names whose owner doesn't live long enough
+  // to be a key
+  uint32_t intern_name(const std::string &name);
+
+  void record(CrossingKind kind, uint32_t name_id, int64_t start_usec, int64_t end_usec);
+
+  // Write the recorded events to `path` (which can be a res:// or user://
+  // path) as Chrome trace event JSON
+  bool dump(const godot::String &path);
+
+private:
+  CrossingTrace() = default;
+
+  struct Event {
+    int64_t start_usec;
+    int64_t duration_usec;
+    uint32_t name_id;
+    uint32_t thread_id;
+    CrossingKind kind;
+  };
+
+  static uint32_t current_thread_id();
+
+  static const uint8_t kTraceFlag = 1;
+  static const uint8_t kFrameStatsFlag = 2;
+  static std::atomic<uint8_t> s_flags;
+
+  std::vector<Event> _events;
+  std::atomic<uint64_t> _next_event = 0;
+  uint32_t _main_thread_id = 0;
+
+  std::mutex _names_lock;
+  // Index 0 is the empty name, used for crossings named by their kind
+  std::vector<std::string> _names = {std::string()};
+  std::unordered_map<const void *, uint32_t> _name_ids;
+  std::unordered_map<std::string, uint32_t> _named_ids;
+};
+
+// Records the crossing it's alive for in the trace and the per-frame stats,
+// whichever are enabled. Names are only looked up while tracing.
+class CrossingTraceScope {
+public:
+  explicit CrossingTraceScope(CrossingKind kind) : _kind(kind), _name_id(0), _start_usec(-1) {
+    if (CrossingTrace::is_recording()) {
+      start();
+    }
+  }
+
+  CrossingTraceScope(CrossingKind kind, const godot::StringName &name);
+  // `name_id` is from CrossingTrace::intern_name
+  CrossingTraceScope(CrossingKind kind, uint32_t name_id) : _kind(kind), _name_id(name_id), _start_usec(-1) {
+    if (CrossingTrace::is_recording()) {
+      start();
+    }
+  }
+
+  // `name` must be a string literal
+  CrossingTraceScope(CrossingKind kind, const char *name) : _kind(kind), _name_id(0), _start_usec(-1) {
+    if (CrossingTrace::is_enabled()) {
+      _name_id = CrossingTrace::instance()->intern(name, [name] { return std::string(name); });
+    }
+    if (CrossingTrace::is_recording()) {
+      start();
+    }
+  }
+
+  // For names that are expensive to get, such as those read from Dart
+  // objects. `get_name` is only called the first time `key` is traced.
+  template <typename F>
+  CrossingTraceScope(CrossingKind kind, const void *key, F get_name) : _kind(kind), _name_id(0), _start_usec(-1) {
+    if (CrossingTrace::is_enabled()) {
+      _name_id = CrossingTrace::instance()->intern(key, get_name);
+    }
+    if (CrossingTrace::is_recording()) {
+      start();
+    }
+  }
+
+  ~CrossingTraceScope() {
+    if (_start_usec >= 0) {
+      finish();
+    }
+  }
+
+private:
+  void start();
+  void finish();
+
+  CrossingKind _kind;
+  uint32_t _name_id;
+  int64_t _start_usec;
+};
@@ -1,14 +1,71 @@
 /// This file contains the C functions that Dart will call into.
 /// The Dart bindings for these are contained in dart_binding_c_interface.dart
+#include <thread>
+
 #include <dart_api.h>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/variant/variant.hpp>
 
+#include "crossing_trace.h"
 #include "dart_bindings.h"
 #include "dart_helpers.h"
+#include "dart_thread_pool_tasks.h"
+#include "dart_worker_pool.h"
+#include "deferred_destroy_queue.h"
+#include "deferred_signal_queue.h"
 #include "gde_wrapper.h"
 #include "godot_string_wrappers.h"
+#include "packed_math_kernels.h"
+#include "runtime_stats.h"
+#include "scratch_allocator.h"
+#include "size_class_pool.h"
+#include "variant_cell_pool.h"
 #include "script/dart_script_instance.h"
 #include "script/dart_script_language.h"
 
+static godot::String dart_string_to_godot(Dart_Handle dart_string) {
+  const char *cstring = nullptr;
+  if (Dart_IsError(Dart_StringToCString(dart_string, &cstring))) {
+    return godot::String();
+  }
+  return godot::String::utf8(cstring);
+}
+
+template <typename T>
+static void *packed_array_data(GDExtensionTypePtr packed_array, int64_t *r_size_in_bytes) {
+  T *array = reinterpret_cast<T *>(packed_array);
+  *r_size_in_bytes = array->size() * static_cast<int64_t>(sizeof(*array->ptr()));
+  // ptrw makes the array's storage unique, so the pointer isn't shared with other copies
+  return array->is_empty() ? nullptr : array->ptrw();
+}
+
+// The number of floats in a packed array of float based elements (floats,
+// vectors or colors), or -1 for any other type
+template <typename T>
+static int64_t packed_array_floats(GDExtensionConstTypePtr packed_array, const float **r_data) {
+  const T *array = reinterpret_cast<const T *>(packed_array);
+  *r_data = reinterpret_cast<const float *>(array->ptr());
+  return array->size() * static_cast<int64_t>(sizeof(*array->ptr()) / sizeof(float));
+}
+
+static int64_t packed_array_floats(GDExtensionConstTypePtr packed_array, int32_t variant_type, const float **r_data) {
+  switch (variant_type) {
+  case godot::Variant::PACKED_FLOAT32_ARRAY:
+    return packed_array_floats<godot::PackedFloat32Array>(packed_array, r_data);
+  case godot::Variant::PACKED_VECTOR2_ARRAY:
+    return packed_array_floats<godot::PackedVector2Array>(packed_array, r_data);
+  case godot::Variant::PACKED_VECTOR3_ARRAY:
+    return packed_array_floats<godot::PackedVector3Array>(packed_array, r_data);
+  case godot::Variant::PACKED_COLOR_ARRAY:
+    return packed_array_floats<godot::PackedColorArray>(packed_array, r_data);
+  case godot::Variant::PACKED_VECTOR4_ARRAY:
+    return packed_array_floats<godot::PackedVector4Array>(packed_array, r_data);
+  default:
+    *r_data = nullptr;
+    return -1;
+  }
+}
+
 /* Static Functions From Dart */
 extern "C" {
 
@@ -188,74 +245,79 @@ GDE_EXPORT GDExtensionScriptInstanceDataPtr get_script_instance(GDExtensionConst
   return gde_object_get_script_instance(godot_object, script_language->_owner);
 }
 
+// True if a call on this thread should go through the DeferredSignalQueue
+// instead of waiting for the isolate
+static bool should_defer_signal(const DartSignalCallable *signal, GodotDartBindings *bindings) {
+  if (!signal->deferred) {
+    return false;
+  }
+  std::thread::id this_thread = std::this_thread::get_id();
+  return this_thread != bindings->_main_thread_id && this_thread != bindings->_isolate_current_thread;
+}
+
 GDE_EXPORT void call_dart_signal(void *callable_userdata, const GDExtensionConstVariantPtr *p_args,
                                  GDExtensionInt p_argument_count, GDExtensionVariantPtr r_return,
                                  GDExtensionCallError *r_error) {
   GodotDartBindings *bindings = GodotDartBindings::instance();
+  DartSignalCallable *signal = reinterpret_cast<DartSignalCallable *>(callable_userdata);
+
+  if (should_defer_signal(signal, bindings)) {
+    DeferredSignalQueue::instance()->push_call(signal, p_args, p_argument_count);
+    *r_error = GDExtensionCallError{GDEXTENSION_CALL_OK, 0, 0};
+    return;
+  }
 
   bindings->execute_on_dart_thread([&] {
-    DartBlockScope scope;
-
-    Dart_Handle signal = Dart_HandleFromPersistent((Dart_PersistentHandle)callable_userdata);
-    Dart_Handle convert_args[] = {Dart_NewInteger(int64_t(p_args)), Dart_NewInteger(p_argument_count)};
-    DART_CHECK(
-        signal_args,
-        Dart_Invoke(bindings->_native_library, Dart_NewStringFromCString("_variantsToDartVariants"), 2, convert_args),
-        "Failed to convert variants to Dart.");
-
-    Dart_Handle args[] = {signal_args};
-    Dart_Handle result = Dart_Invoke(signal, Dart_NewStringFromCString("call"), 1, args);
-    if (Dart_IsError(result)) {
-      GD_PRINT_ERROR("GodotDart: Error performing signal call: ");
-      GD_PRINT_ERROR(Dart_GetError(result));
+    if (signal->call(p_args, p_argument_count)) {
+      *r_error = GDExtensionCallError{GDEXTENSION_CALL_OK, 0, 0};
+    } else {
       *r_error = GDExtensionCallError{
           GDEXTENSION_CALL_ERROR_INVALID_METHOD,
           0,
           0,
       };
-    } else {
-      *r_error = GDExtensionCallError{GDEXTENSION_CALL_OK, 0, 0};
     }
   });
 }
 
 GDExtensionInt get_signal_argument_count(void *callable_userdata, GDExtensionBool *r_is_valid) {
-  GodotDartBindings *bindings = GodotDartBindings::instance();
-
-  int64_t arg_count;
-  bindings->execute_on_dart_thread([&] {
-    DartBlockScope scope;
-    Dart_Handle signal = Dart_HandleFromPersistent((Dart_PersistentHandle)callable_userdata);
-
-    Dart_Handle arg_count_h = Dart_GetField(signal, Dart_NewStringFromCString("arguments"));
-    Dart_IntegerToInt64(arg_count_h, &arg_count);
-  });
-
-  return arg_count;
+  *r_is_valid = true;
+  return reinterpret_cast<DartSignalCallable *>(callable_userdata)->argument_count;
 }
 
 void free_dart_signal(void *callable_userdata) {
   GodotDartBindings *bindings = GodotDartBindings::instance();
+  DartSignalCallable *signal = reinterpret_cast<DartSignalCallable *>(callable_userdata);
+  if (bindings == nullptr || bindings->_is_stopping) {
+    // Dart is gone, and its handles with it
+    delete signal;
+    return;
+  }
 
-  bindings->execute_on_dart_thread([&] {
-    DartBlockScope scope;
-
-    Dart_Handle signal = Dart_HandleFromPersistent((Dart_PersistentHandle)callable_userdata);
-    Dart_Invoke(signal, Dart_NewStringFromCString("clear"), 0, nullptr);
-
-    Dart_DeletePersistentHandle((Dart_PersistentHandle)callable_userdata);
-  });
+  // This can run inside a finalizer, if Dart held the last reference to the
+  // Callable, where calling into Dart isn't allowed. The queue releases it
+  // during frame maintenance instead, after any deferred calls to it.
+  DeferredSignalQueue::instance()->push_free(signal);
 }
 
-GDE_EXPORT Dart_Handle create_signal_callable(Dart_Handle signal_callable, GDObjectInstanceID target) {
+GDE_EXPORT Dart_Handle create_signal_callable(Dart_Handle signal_callable, GDObjectInstanceID target, bool deferred) {
   GDEWrapper *gde = GDEWrapper::instance();
 
+  DartSignalCallable *signal = new DartSignalCallable();
+  signal->signal = Dart_NewPersistentHandle(signal_callable);
+  RuntimeStats::increment(RuntimeCounter::PersistentHandles);
+  Dart_IntegerToInt64(Dart_GetField(signal_callable, Dart_NewStringFromCString("arguments")),
+                      &signal->argument_count);
+  signal->deferred = deferred;
+  signal->object_id = target;
+
   GDExtensionCallableCustomInfo2 info = {};
-  info.callable_userdata = Dart_NewPersistentHandle(signal_callable);
+  info.callable_userdata = signal;
   info.token = gde->get_library_ptr();
   info.object_id = target;
   info.call_func = call_dart_signal;
   info.get_argument_count_func = get_signal_argument_count;
+  info.free_func = free_dart_signal;
 
   godot::Callable callable;
   godot::internal::gdextension_interface_callable_custom_create2(callable._native_ptr(), &info);
@@ -268,32 +330,236 @@ GDE_EXPORT Dart_Handle create_signal_callable(Dart_Handle signal_callable, GDObj
   return dart_callable;
 }
 
-GDE_EXPORT void finalize_variant(GDExtensionVariantPtr variant) {
-  if (variant == nullptr) {
+GDE_EXPORT void *gde_pool_alloc(size_t size) {
+  return SizeClassPool::instance()->alloc(size);
+}
+
+GDE_EXPORT void gde_pool_free(void *ptr) {
+  SizeClassPool::instance()->free(ptr);
+}
+
+GDE_EXPORT int32_t gde_pool_size_class_count() {
+  return static_cast<int32_t>(SizeClassPool::kSizeClassCount);
+}
+
+GDE_EXPORT bool gde_pool_get_stats(int32_t size_class, GDEPoolStats *stats) {
+  return SizeClassPool::instance()->get_stats(size_class, stats);
+}
+
+GDE_EXPORT uint64_t gde_scratch_mark() {
+  return ScratchAllocator::current()->mark();
+}
+
+GDE_EXPORT void *gde_scratch_alloc(size_t size, size_t alignment) {
+  return ScratchAllocator::current()->alloc(size, alignment);
+}
+
+GDE_EXPORT void gde_scratch_reset(uint64_t mark) {
+  ScratchAllocator::current()->reset(mark);
+}
+
+GDE_EXPORT int32_t gde_worker_pool_acquire() {
+  return DartWorkerPool::instance()->acquire();
+}
+
+GDE_EXPORT void gde_worker_pool_release(int32_t worker) {
+  DartWorkerPool::instance()->release(worker);
+}
+
+GDE_EXPORT Dart_Handle gde_worker_pool_send_port(int32_t worker) {
+  Dart_Port port = DartWorkerPool::instance()->get_port(worker);
+  if (port == ILLEGAL_PORT) {
+    return Dart_Null();
+  }
+  return Dart_NewSendPort(port);
+}
+
+GDE_EXPORT void *gde_packed_array_data(GDExtensionTypePtr packed_array, int32_t variant_type,
+                                       int64_t *r_size_in_bytes) {
+  *r_size_in_bytes = 0;
+  switch (variant_type) {
+  case godot::Variant::PACKED_BYTE_ARRAY:
+    return packed_array_data<godot::PackedByteArray>(packed_array, r_size_in_bytes);
+  case godot::Variant::PACKED_INT32_ARRAY:
+    return packed_array_data<godot::PackedInt32Array>(packed_array, r_size_in_bytes);
+  case godot::Variant::PACKED_INT64_ARRAY:
+    return packed_array_data<godot::PackedInt64Array>(packed_array, r_size_in_bytes);
+  case godot::Variant::PACKED_FLOAT32_ARRAY:
+    return packed_array_data<godot::PackedFloat32Array>(packed_array, r_size_in_bytes);
+  case godot::Variant::PACKED_FLOAT64_ARRAY:
+    return packed_array_data<godot::PackedFloat64Array>(packed_array, r_size_in_bytes);
+  case godot::Variant::PACKED_VECTOR2_ARRAY:
+    return packed_array_data<godot::PackedVector2Array>(packed_array, r_size_in_bytes);
+  case godot::Variant::PACKED_VECTOR3_ARRAY:
+    return packed_array_data<godot::PackedVector3Array>(packed_array, r_size_in_bytes);
+  case godot::Variant::PACKED_COLOR_ARRAY:
+    return packed_array_data<godot::PackedColorArray>(packed_array, r_size_in_bytes);
+  case godot::Variant::PACKED_VECTOR4_ARRAY:
+    return packed_array_data<godot::PackedVector4Array>(packed_array, r_size_in_bytes);
+  default:
+    // PackedStringArray (and anything else) isn't plain data
+    *r_size_in_bytes = -1;
+    return nullptr;
+  }
+}
+
+GDE_EXPORT int64_t gde_thread_pool_add_task(Dart_Handle task, int64_t buffer_address, int64_t buffer_length,
+                                            bool high_priority, Dart_Handle description) {
+  return DartThreadPoolTasks::instance()->add_task(task, buffer_address, buffer_length, high_priority,
+                                                   dart_string_to_godot(description));
+}
+
+GDE_EXPORT int64_t gde_thread_pool_add_group_task(Dart_Handle task, int64_t element_count, int64_t batch_size,
+                                                  int32_t tasks_needed, int64_t buffer_address, int64_t buffer_length,
+                                                  bool high_priority, Dart_Handle description) {
+  return DartThreadPoolTasks::instance()->add_group_task(task, element_count, batch_size, tasks_needed,
+                                                         buffer_address, buffer_length, high_priority,
+                                                         dart_string_to_godot(description));
+}
+
+// Not leaf calls, so the waiting thread is at a safepoint and the helper
+// isolates running the tasks can still garbage collect
+GDE_EXPORT void gde_thread_pool_wait_task(int64_t task_id) {
+  godot::WorkerThreadPool::get_singleton()->wait_for_task_completion(task_id);
+}
+
+GDE_EXPORT void gde_thread_pool_wait_group_task(int64_t group_id) {
+  godot::WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+}
+
+GDE_EXPORT bool gde_crossing_trace_enabled() {
+  return CrossingTrace::is_enabled();
+}
+
+GDE_EXPORT bool gde_crossing_trace_dump(Dart_Handle path) {
+  return CrossingTrace::instance()->dump(dart_string_to_godot(path));
+}
+
+GDE_EXPORT void gde_packed_vector2_transform(GDExtensionTypePtr packed_array, GDExtensionConstTypePtr transform) {
+  godot::PackedVector2Array *array = reinterpret_cast<godot::PackedVector2Array *>(packed_array);
+  if (array->is_empty()) {
+    return;
+  }
+  packed_vector2_transform(array->ptrw(), array->size(), *reinterpret_cast<const godot::Transform2D *>(transform));
+}
+
+GDE_EXPORT void gde_packed_vector3_transform(GDExtensionTypePtr packed_array, GDExtensionConstTypePtr transform) {
+  godot::PackedVector3Array *array = reinterpret_cast<godot::PackedVector3Array *>(packed_array);
+  if (array->is_empty()) {
     return;
   }
+  packed_vector3_transform(array->ptrw(), array->size(), *reinterpret_cast<const godot::Transform3D *>(transform));
+}
 
-  gde_variant_destroy(variant);
-  gde_mem_free(variant);
+// Both arrays must be the same type and size. Returns false if they aren't.
+GDE_EXPORT bool gde_packed_array_lerp(GDExtensionTypePtr packed_array, GDExtensionConstTypePtr to,
+                                      int32_t variant_type, float weight) {
+  const float *to_data = nullptr;
+  int64_t to_count = packed_array_floats(to, variant_type, &to_data);
+  const float *from_data = nullptr;
+  int64_t count = packed_array_floats(packed_array, variant_type, &from_data);
+  if (count < 0 || count != to_count) {
+    return false;
+  }
+  if (count == 0) {
+    return true;
+  }
+
+  int64_t size_in_bytes = 0;
+  float *data = reinterpret_cast<float *>(gde_packed_array_data(packed_array, variant_type, &size_in_bytes));
+  packed_float_lerp(data, to_data, count, weight);
+  return true;
+}
+
+GDE_EXPORT void gde_packed_vector2_normalize(GDExtensionTypePtr packed_array) {
+  godot::PackedVector2Array *array = reinterpret_cast<godot::PackedVector2Array *>(packed_array);
+  if (array->is_empty()) {
+    return;
+  }
+  packed_vector2_normalize(array->ptrw(), array->size());
+}
+
+GDE_EXPORT void gde_packed_vector3_normalize(GDExtensionTypePtr packed_array) {
+  godot::PackedVector3Array *array = reinterpret_cast<godot::PackedVector3Array *>(packed_array);
+  if (array->is_empty()) {
+    return;
+  }
+  packed_vector3_normalize(array->ptrw(), array->size());
+}
+
+GDE_EXPORT void gde_packed_vector2_distance_to(GDExtensionConstTypePtr packed_array, GDExtensionConstTypePtr point,
+                                               GDExtensionTypePtr r_distances) {
+  const godot::PackedVector2Array *array = reinterpret_cast<const godot::PackedVector2Array *>(packed_array);
+  godot::PackedFloat32Array *distances = reinterpret_cast<godot::PackedFloat32Array *>(r_distances);
+  distances->resize(array->size());
+  if (array->is_empty()) {
+    return;
+  }
+  packed_vector2_distance_to(array->ptr(), array->size(), *reinterpret_cast<const godot::Vector2 *>(point),
+                             distances->ptrw());
+}
+
+GDE_EXPORT void gde_packed_vector3_distance_to(GDExtensionConstTypePtr packed_array, GDExtensionConstTypePtr point,
+                                               GDExtensionTypePtr r_distances) {
+  const godot::PackedVector3Array *array = reinterpret_cast<const godot::PackedVector3Array *>(packed_array);
+  godot::PackedFloat32Array *distances = reinterpret_cast<godot::PackedFloat32Array *>(r_distances);
+  distances->resize(array->size());
+  if (array->is_empty()) {
+    return;
+  }
+  packed_vector3_distance_to(array->ptr(), array->size(), *reinterpret_cast<const godot::Vector3 *>(point),
+                             distances->ptrw());
+}
+
+// Fills `r_indices` with the indices of the points inside `aabb`
+GDE_EXPORT void gde_packed_vector3_cull_aabb(GDExtensionConstTypePtr packed_array, GDExtensionConstTypePtr aabb,
+                                             GDExtensionTypePtr r_indices) {
+  const godot::PackedVector3Array *array = reinterpret_cast<const godot::PackedVector3Array *>(packed_array);
+  godot::PackedInt32Array *indices = reinterpret_cast<godot::PackedInt32Array *>(r_indices);
+  indices->resize(array->size());
+  if (array->is_empty()) {
+    return;
+  }
+  int64_t found = packed_vector3_cull_aabb(array->ptr(), array->size(), *reinterpret_cast<const godot::AABB *>(aabb),
+                                           indices->ptrw());
+  indices->resize(found);
+}
+
+GDE_EXPORT GDExtensionVariantPtr gde_variant_pool_alloc() {
+  return VariantCellPool::instance()->alloc();
+}
+
+GDE_EXPORT void finalize_variant(GDExtensionVariantPtr variant) {
+  // Destroyed in a batch by VariantCellPool::collect during frame maintenance
+  VariantCellPool::instance()->release(variant);
 }
 
 GDE_EXPORT void finalize_builtin_object(uint8_t *builtin_object_info) {
   if (builtin_object_info == nullptr) {
     return;
   }
+  CrossingTraceScope trace(CrossingKind::Finalizer, "finalize_builtin_object");
 
   GDExtensionPtrDestructor *destructor = reinterpret_cast<GDExtensionPtrDestructor *>(builtin_object_info);
   void *opaque = builtin_object_info + sizeof(GDExtensionPtrDestructor);
   if (*destructor != nullptr) {
     (*destructor)(opaque);
   }
-  gde_mem_free(builtin_object_info);
+  gde_pool_free(builtin_object_info);
 }
 
 GDE_EXPORT void finalize_extension_object(GDExtensionObjectPtr extention_object) {
   if (extention_object == nullptr) {
     return;
   }
+  CrossingTraceScope trace(CrossingKind::Finalizer, "finalize_extension_object");
+
+  GodotDartBindings *bindings = GodotDartBindings::instance();
+  // Destroyed during frame maintenance, outside of the GC, unless the queue
+  // is full
+  if (bindings != nullptr && !bindings->_is_stopping && DeferredDestroyQueue::instance()->push(extention_object)) {
+    return;
+  }
 
   gde_object_destroy(extention_object);
 }
@@ -1,8 +1,11 @@
 ﻿#include "dart_bindings.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <functional>
 #include <iostream>
 #include <string.h>
+#include <string>
 #include <thread>
 
 #include <dart_api.h>
@@ -12,15 +15,24 @@
 #include <gdextension_interface.h>
 #include <godot_cpp/classes/editor_file_system.hpp>
 #include <godot_cpp/classes/editor_interface.hpp>
+#include <godot_cpp/classes/os.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
 #include <godot_cpp/godot.hpp>
 #include <godot_cpp/variant/string.hpp>
 #include <godot_cpp/variant/string_name.hpp>
 
+#include "crossing_trace.h"
 #include "dart_helpers.h"
 #include "dart_instance_binding.h"
+#include "dart_thread_pool_tasks.h"
+#include "dart_worker_pool.h"
+#include "deferred_destroy_queue.h"
+#include "deferred_signal_queue.h"
 #include "gde_dart_converters.h"
 #include "gde_wrapper.h"
 #include "ref_counted_wrapper.h"
+#include "runtime_stats.h"
+#include "variant_cell_pool.h"
 #include "script/dart_script_instance.h"
 #include "script/dart_script_language.h"
 
@@ -32,16 +44,52 @@ GodotDartBindings::~GodotDartBindings() {
   _instance = nullptr;
 }
 
-bool GodotDartBindings::initialize(const char *script_path, const char *package_config) {
+bool GodotDartBindings::initialize(const char *script_path, const char *package_config, const char *snapshot_path) {
   DartDllConfig config;
   if (GDEWrapper::instance()->is_editor_hint()) {
     config.service_port = 6222;
   }
-  DartDll_Initialize(config);
+  // The VM only accepts flags once and dart_dll exposes no way to add to its
+  // own Dart_SetVMFlags call, so ours go first and the VM rejects the later
+  // one. That's only done when a heap setting is set, and if dart_dll can't
+  // live without its flags it fails loudly here rather than silently.
+  bool has_vm_flags = apply_vm_flags();
+  if (!DartDll_Initialize(config)) {
+    GD_PRINT_ERROR("GodotDart: Initialization Error (Failed to initialize the Dart VM)");
+    if (has_vm_flags) {
+      GD_PRINT_ERROR("GodotDart: The Dart VM may not accept the Dart heap settings, try resetting them");
+    }
+    return false;
+  }
+
+  int64_t destroy_budget = godot::ProjectSettings::get_singleton()->get_setting(DART_SETTING_DESTROY_BUDGET_USEC,
+                                                                               DART_DEFAULT_DESTROY_BUDGET_USEC);
+  _destroy_budget_usec = destroy_budget > 0 ? destroy_budget : 0;
+  // Finalizers push to the queue and mustn't be the ones to allocate it
+  DeferredDestroyQueue::instance();
+
+  if (godot::ProjectSettings::get_singleton()->get_setting(DART_SETTING_TRACE_CROSSINGS, false)) {
+    CrossingTrace::instance()->start();
+  }
+  // Timing every crossing isn't free, so release exports never do it
+  bool crossing_stats = godot::OS::get_singleton()->is_debug_build() &&
+                        godot::ProjectSettings::get_singleton()->get_setting(DART_SETTING_CROSSING_STATS, true);
+  CrossingTrace::set_frame_stats_enabled(crossing_stats);
 
   // Capture the current isolate before it even exists
   _isolate_current_thread = std::this_thread::get_id();
-  _isolate = DartDll_LoadScript(script_path, package_config);
+  _main_thread_id = _isolate_current_thread;
+  if (snapshot_path != nullptr) {
+    // dart_dll sniffs the file for a kernel or AppJIT snapshot header and
+    // skips the kernel service compile if it finds one.
+    _isolate = DartDll_LoadScript(snapshot_path, package_config);
+    if (_isolate == nullptr) {
+      GD_PRINT_WARNING("GodotDart: Failed to load precompiled snapshot, falling back to source");
+    }
+  }
+  if (_isolate == nullptr && script_path != nullptr) {
+    _isolate = DartDll_LoadScript(script_path, package_config);
+  }
   if (_isolate == nullptr) {
     GD_PRINT_ERROR("GodotDart: Initialization Error (Failed to load script)");
     _isolate_current_thread = std::thread::id();
@@ -107,13 +155,26 @@ bool GodotDartBindings::initialize(const char *script_path, const char *package_
       Dart_Handle mainFunctionName = Dart_NewStringFromCString("main");
       DART_CHECK_RET(result, Dart_Invoke(library, mainFunctionName, 0, nullptr), false, "Error calling 'main'");
     }
+
+    // Resolve every script up front so scene instantiation doesn't pay for it per node
+    DartScriptLanguage::instance()->prewarm_script_types();
   }
 
   Dart_ExitIsolate();
   _isolate_current_thread = std::thread::id();
 
+  // Workers are created in the main isolate's group, which requires that no
+  // thread has entered it
+  start_worker_isolates();
+
   _fully_initialized = true;
 
+  // Outside the editor, scripts that haven't been loaded yet are loaded now,
+  // once the isolate is free for the loader to call back into
+  if (!GDEWrapper::instance()->is_editor_hint()) {
+    DartScriptLanguage::instance()->load_uncached_scripts();
+  }
+
   return true;
 }
 
@@ -136,6 +197,17 @@ void GodotDartBindings::reload_code() {
 }
 
 void GodotDartBindings::shutdown() {
+  if (CrossingTrace::is_enabled()) {
+    // Stop first, so the trace ends with the last frames instead of shutdown
+    CrossingTrace::instance()->stop();
+    godot::String trace_path =
+        godot::ProjectSettings::get_singleton()->get_setting(DART_SETTING_TRACE_PATH, DART_DEFAULT_TRACE_PATH);
+    CrossingTrace::instance()->dump(trace_path);
+  }
+
+  DartThreadPoolTasks::instance()->shutdown();
+  DartWorkerPool::instance()->stop();
+
   Dart_EnterIsolate(_isolate);
   _isolate_current_thread = std::this_thread::get_id();
 
@@ -150,6 +222,7 @@ void GodotDartBindings::shutdown() {
     GD_PRINT_ERROR(Dart_GetError(result));
   }
 
+  DartScriptLanguage::instance()->clear_script_type_cache();
   Dart_DeletePersistentHandle(_native_library);
   Dart_DeletePersistentHandle(_godot_dart_library);
 
@@ -157,10 +230,69 @@ void GodotDartBindings::shutdown() {
   Dart_ExitScope();
   //Dart_ExitIsolate();
 
+  DeferredSignalQueue::instance()->dispatch();
+  // Destroy released Variants while their Objects' bindings can still delete
+  // their handles
+  VariantCellPool::instance()->collect();
+
   _is_stopping = true;
+  // Finalizers now destroy objects immediately, so this is the last of the queue
+  DeferredDestroyQueue::instance()->process(0);
   Dart_ShutdownIsolate();
   DartDll_Shutdown();
+  // Anything released by finalizers during shutdown. With the VM gone,
+  // bindings freed from here must not touch their handles.
   _instance = nullptr;
+  VariantCellPool::instance()->collect();
+}
+
+bool GodotDartBindings::apply_vm_flags() {
+  godot::ProjectSettings *project_settings = godot::ProjectSettings::get_singleton();
+  int64_t old_gen_heap_mb = project_settings->get_setting(DART_SETTING_OLD_GEN_HEAP_MB, 0);
+  int64_t new_gen_semi_mb = project_settings->get_setting(DART_SETTING_NEW_GEN_SEMI_MB, 0);
+
+  std::vector<std::string> flags;
+  if (old_gen_heap_mb > 0) {
+    flags.push_back("--old_gen_heap_size=" + std::to_string(old_gen_heap_mb));
+  }
+  if (new_gen_semi_mb > 0) {
+    flags.push_back("--new_gen_semi_max_size=" + std::to_string(new_gen_semi_mb));
+  }
+  if (flags.empty()) {
+    return false;
+  }
+
+  std::vector<const char *> flag_ptrs;
+  for (const auto &flag : flags) {
+    flag_ptrs.push_back(flag.c_str());
+  }
+  char *error = Dart_SetVMFlags(static_cast<int>(flag_ptrs.size()), flag_ptrs.data());
+  if (error != nullptr) {
+    GD_PRINT_WARNING("GodotDart: Failed to apply Dart VM memory settings:");
+    GD_PRINT_WARNING(error);
+    free(error);
+    return false;
+  }
+  return true;
+}
+
+void GodotDartBindings::start_worker_isolates() {
+  int64_t worker_count = godot::ProjectSettings::get_singleton()->get_setting(DART_SETTING_WORKER_ISOLATES,
+                                                                             DART_DEFAULT_WORKER_ISOLATES);
+  if (worker_count < 0) {
+    worker_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+  }
+
+  // Always started, even without workers, as thread pool tasks need its seed
+  // isolate. The workers themselves start with the first job.
+  if (!DartWorkerPool::instance()->start(_isolate, static_cast<int32_t>(worker_count))) {
+    GD_PRINT_WARNING("GodotDart: Could not start the worker pool");
+  }
+}
+
+void GodotDartBindings::notify_low_memory() {
+  // Doesn't need a current isolate
+  Dart_NotifyLowMemory();
 }
 
 void GodotDartBindings::set_type_resolver(Dart_Handle type_resolver) {
@@ -174,6 +306,7 @@ void GodotDartBindings::execute_on_dart_thread(std::function<void()> work) {
     return;
   }
 
+  CrossingTraceScope trace(CrossingKind::EnterIsolate);
   _work_lock.lock();
   _isolate_current_thread = std::this_thread::get_id();
   Dart_EnterIsolate(_isolate);
@@ -198,12 +331,22 @@ void GodotDartBindings::perform_frame_maintanance() {
     while (_pending_messages > 0) {
       DART_CHECK(err, Dart_HandleMessage(), "Failure handling dart message");
       _pending_messages--;
+      RuntimeStats::decrement(RuntimeCounter::PendingDartMessages);
     }
 
+    // Deliver signals emitted from other threads since the last frame
+    DeferredSignalQueue::instance()->dispatch();
+
     // Back with a current isolate, let's take care of any pending ref count changes,
     // which we couldn't do while the finalizer was running.
     perform_pending_ref_changes();
 
+    // Destroy and recycle any Variants released by the finalizer
+    VariantCellPool::instance()->collect();
+
+    // And any objects, within our time budget
+    DeferredDestroyQueue::instance()->process(_destroy_budget_usec);
+
     // If we're reloading, check to see if we're done.
     if (_is_reloading) {
       Dart_Handle root_library = Dart_HandleFromPersistent(_godot_dart_library);
@@ -215,19 +358,30 @@ void GodotDartBindings::perform_frame_maintanance() {
       }
     }
 
+    RuntimeStats::sample_to_timeline();
+
     uint64_t currentTime = Dart_TimelineGetMicros();
     Dart_NotifyIdle(currentTime + 1000); // Idle for 1 ms... maybe more
 
     Dart_ExitScope();
   });
+
+  // Close out this frame's crossings, including those made by the maintenance
+  // above, for the monitors
+  for (int32_t i = 0; i < static_cast<int32_t>(CrossingKind::Count); ++i) {
+    _frame_crossing_counts[i] = _crossing_counts[i].exchange(0, std::memory_order_relaxed);
+    _frame_crossing_usec[i] = _crossing_usec[i].exchange(0, std::memory_order_relaxed);
+  }
 }
 
 void GodotDartBindings::add_pending_ref_change(DartGodotInstanceBinding *bindings) {
   _pending_ref_changes.insert(bindings);
+  RuntimeStats::set(RuntimeCounter::PendingRefChanges, _pending_ref_changes.size());
 }
 
 void GodotDartBindings::remove_pending_ref_change(DartGodotInstanceBinding *binding) {
   _pending_ref_changes.erase(binding);
+  RuntimeStats::set(RuntimeCounter::PendingRefChanges, _pending_ref_changes.size());
 }
 
 void GodotDartBindings::perform_pending_ref_changes() {
@@ -241,6 +395,7 @@ void GodotDartBindings::perform_pending_ref_changes() {
     }
   }
   _pending_ref_changes.clear();
+  RuntimeStats::set(RuntimeCounter::PendingRefChanges, 0);
 }
 
 void GodotDartBindings::bind_method(Dart_Handle dart_type_info, Dart_Handle dart_method_info) {
@@ -353,6 +508,7 @@ Dart_Handle GodotDartBindings::new_dart_object(Dart_Handle type_name) {
 }
 
 Dart_Handle GodotDartBindings::new_godot_owned_object(Dart_Handle type, void *ptr) {
+  CrossingTraceScope trace(CrossingKind::ObjectCreation);
   DART_CHECK_RET(type_resolver, Dart_HandleFromPersistent(_type_resolver), Dart_Null(), "Failed to get type resolver");
 
   Dart_Handle args[] = {type, Dart_NewInteger(int64_t(ptr))};
@@ -470,6 +626,8 @@ void GodotDartBindings::bind_call(void *method_userdata, GDExtensionClassInstanc
     Dart_Handle dart_instance = binding->get_dart_object();
 
     Dart_Handle dart_method_info = Dart_HandleFromPersistent(reinterpret_cast<Dart_PersistentHandle>(method_userdata));
+    CrossingTraceScope trace(CrossingKind::MethodCall, method_userdata,
+                             [&] { return CrossingTrace::get_dart_name(dart_method_info); });
 
     Dart_Handle dart_args[] = {
         dart_instance,
@@ -511,6 +669,7 @@ GDExtensionObjectPtr GodotDartBindings::class_create_instance(void *p_userdata)
   uint64_t real_address = 0;
   bindings->execute_on_dart_thread([&]() {
     DartBlockScope scope;
+    CrossingTraceScope trace(CrossingKind::ObjectCreation);
 
     Dart_Handle type_info = Dart_HandleFromPersistent(reinterpret_cast<Dart_PersistentHandle>(p_userdata));
     DART_CHECK(constructor_tearoff, Dart_GetField(type_info, Dart_NewStringFromCString("constructObjectDefault")),
@@ -579,6 +738,7 @@ void GodotDartBindings::call_virtual_func(void *p_instance, GDExtensionConstStri
 
   gde->execute_on_dart_thread([&]() {
     DartBlockScope scope;
+    CrossingTraceScope trace(CrossingKind::VirtualCall, *reinterpret_cast<const godot::StringName *>(p_name));
 
     DartGodotInstanceBinding *binding = reinterpret_cast<DartGodotInstanceBinding *>(p_instance);
     Dart_Handle dart_instance = binding->get_dart_object();
@@ -605,4 +765,5 @@ void dart_message_notify_callback(Dart_Isolate isolate) {
 
   // TODO: Does this need to be thread safe?
   bindings->_pending_messages++;
+  RuntimeStats::increment(RuntimeCounter::PendingDartMessages);
 }
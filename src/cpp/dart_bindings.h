@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <mutex>
 #include <semaphore>
@@ -13,10 +14,31 @@
 #include <godot_cpp/classes/wrapped.hpp>
 #include <godot_cpp/variant/string.hpp>
 
+#include "crossing_trace.h"
 #include "dart_instance_binding.h"
 #include "gde_dart_converters.h"
 #include "script/dart_script.h"
 
+// Project settings that are passed to the VM as flags. 0 means use the VM's
+// default.
+#define DART_SETTING_OLD_GEN_HEAP_MB "dart/runtime/old_gen_heap_mb"
+#define DART_SETTING_NEW_GEN_SEMI_MB "dart/runtime/new_gen_semi_mb"
+// Time spent each frame destroying objects released by Dart finalizers
+#define DART_SETTING_DESTROY_BUDGET_USEC "dart/runtime/destroy_budget_usec"
+#define DART_DEFAULT_DESTROY_BUDGET_USEC 1000
+// Number of worker isolates for background jobs. -1 uses one less than the
+// number of cores, 0 disables them.
+#define DART_SETTING_WORKER_ISOLATES "dart/runtime/worker_isolates"
+#define DART_DEFAULT_WORKER_ISOLATES -1
+// Record Godot <-> Dart crossings, writing them to the trace path as a Chrome
+// trace at exit
+#define DART_SETTING_TRACE_CROSSINGS "dart/runtime/trace_crossings"
+#define DART_SETTING_TRACE_PATH "dart/runtime/trace_path"
+#define DART_DEFAULT_TRACE_PATH "user://godot_dart_trace.json"
+// Count crossings and their time each frame, for the Performance monitors.
+// Only used in debug builds.
+#define DART_SETTING_CROSSING_STATS "dart/runtime/crossing_stats"
+
 enum class MethodFlags : int32_t {
   None,
   PropertyGetter,
@@ -30,17 +52,23 @@ public:
   }
 
   explicit GodotDartBindings()
-      : _is_stopping(false), _fully_initialized(false), _is_reloading(false), _pending_messages(0), _isolate(nullptr) {
+      : _is_stopping(false), _fully_initialized(false), _is_reloading(false), _pending_messages(0), _isolate(nullptr),
+        _destroy_budget_usec(DART_DEFAULT_DESTROY_BUDGET_USEC) {
   }
   ~GodotDartBindings();
 
-  bool initialize(const char *script_path, const char *package_config);
+  // If `snapshot_path` is supplied, it is loaded in place of `script_path`,
+  // which is only compiled if the snapshot fails to load.
+  bool initialize(const char *script_path, const char *package_config, const char *snapshot_path = nullptr);
   bool is_fully_initialized() const {
     return _fully_initialized;
   }
   void shutdown();
   void set_type_resolver(Dart_Handle type_resolver);
   void reload_code();
+  // Ask the VM to release as much memory as it can. Safe to call from any
+  // thread.
+  void notify_low_memory();
 
   Dart_Handle new_dart_object(Dart_Handle type_name);
   Dart_Handle new_godot_owned_object(Dart_Handle type, void *ptr);
@@ -57,6 +85,21 @@ public:
   void remove_pending_ref_change(DartGodotInstanceBinding *bindings);
   void perform_pending_ref_changes();
 
+  // Crossings into Dart by kind, counted from any thread and totalled each
+  // frame by perform_frame_maintanance, if crossing stats are enabled. Time is inclusive, so a crossing
+  // made during another one is counted in both.
+  void record_crossing(CrossingKind kind, int64_t duration_usec) {
+    _crossing_counts[static_cast<int32_t>(kind)].fetch_add(1, std::memory_order_relaxed);
+    _crossing_usec[static_cast<int32_t>(kind)].fetch_add(duration_usec, std::memory_order_relaxed);
+  }
+  // Totals for the last completed frame. Must be called from the main thread.
+  int64_t get_frame_crossing_count(CrossingKind kind) const {
+    return _frame_crossing_counts[static_cast<int32_t>(kind)];
+  }
+  int64_t get_frame_crossing_usec(CrossingKind kind) const {
+    return _frame_crossing_usec[static_cast<int32_t>(kind)];
+  }
+
   static GDExtensionObjectPtr class_create_instance(void *p_userdata);
   static void class_free_instance(void *p_userdata, GDExtensionClassInstancePtr p_instance);
   static void *get_virtual_call_data(void *p_userdata, GDExtensionConstStringNamePtr p_name);
@@ -65,6 +108,10 @@ public:
 
 private:
   void did_finish_hot_reload();
+  // Must be called before DartDll_Initialize. Returns true if any flags were
+  // set.
+  bool apply_vm_flags();
+  void start_worker_isolates();
 
   static void bind_call(void *method_userdata, GDExtensionClassInstancePtr instance,
                         const GDExtensionConstVariantPtr *args, GDExtensionInt argument_count,
@@ -82,8 +129,16 @@ public:
   std::mutex _work_lock;
   Dart_Isolate _isolate;
   std::thread::id _isolate_current_thread;
+  // Initialization happens on Godot's main thread
+  std::thread::id _main_thread_id;
   std::set<godot::Ref<DartScript>> _pending_reloads;
   std::set<DartGodotInstanceBinding *> _pending_ref_changes;
+  uint64_t _destroy_budget_usec;
+
+  std::atomic<int64_t> _crossing_counts[static_cast<int32_t>(CrossingKind::Count)] = {};
+  std::atomic<int64_t> _crossing_usec[static_cast<int32_t>(CrossingKind::Count)] = {};
+  int64_t _frame_crossing_counts[static_cast<int32_t>(CrossingKind::Count)] = {};
+  int64_t _frame_crossing_usec[static_cast<int32_t>(CrossingKind::Count)] = {};
 
   Dart_PersistentHandle _godot_dart_library;
   Dart_PersistentHandle _engine_classes_library;
@@ -3,30 +3,55 @@
 #include <godot_cpp/classes/object.hpp>
 #include <godot_cpp/godot.hpp>
 
+#include "crossing_trace.h"
 #include "dart_bindings.h"
 #include "dart_helpers.h"
+#include "deferred_destroy_queue.h"
 #include "gde_c_interface.h"
 #include "godot_string_wrappers.h"
 #include "ref_counted_wrapper.h"
+#include "runtime_stats.h"
 
 void gde_weak_finalizer(void *isolate_callback_data, void *peer) {
   if (peer == nullptr) {
     return;
   }
+  CrossingTraceScope trace(CrossingKind::Finalizer, "gde_weak_finalizer");
 
   DartGodotInstanceBinding *binding = (DartGodotInstanceBinding *)peer;
+
+  // Releasing the object could destroy it, which we'd rather not do in the
+  // middle of a GC. Leave it for frame maintenance unless we're shutting down.
+  GodotDartBindings *bindings = GodotDartBindings::instance();
+  if (bindings != nullptr && !bindings->_is_stopping) {
+    // The Godot object may be handed back to Dart before the queue runs, in
+    // which case it needs a new Dart object rather than this dead handle
+    binding->_handles_dead.store(true, std::memory_order_release);
+    DeferredDestroyQueue::instance()->push_unreference(binding);
+    return;
+  }
+
+  // Shutting down, so if something else still holds the object there's no
+  // Dart object to recreate. The binding is freed along with the object.
   RefCountedWrapper ref_counted(binding->get_godot_object());
   if (ref_counted.unreference()) {
     gde_object_destroy(binding->get_godot_object());
-  } else {
-    // TODO: Reset the binding so it can recreate the Dart object?
-    assert(false);
   }
 }
 
 std::map<intptr_t, DartGodotInstanceBinding *> DartGodotInstanceBinding::s_instanceMap;
 
+DartGodotInstanceBinding::DartGodotInstanceBinding(Dart_PersistentHandle dart_type_info,
+                                                   GDExtensionObjectPtr godot_object)
+    : _is_refcounted(false), _is_weak(false), _persistent_handle(nullptr), _weak_handle(nullptr),
+      _godot_object(godot_object), _dart_type_info(dart_type_info), _handles_dead(false), _pending_unreferences(0),
+      _next_pending_destroy(nullptr) {
+  RuntimeStats::increment(RuntimeCounter::InstanceBindings);
+}
+
 DartGodotInstanceBinding::~DartGodotInstanceBinding() {
+  RuntimeStats::decrement(RuntimeCounter::InstanceBindings);
+
   GodotDartBindings *bindings = GodotDartBindings::instance();
   // Can't do anything as Dart is shutdown
   if (bindings == nullptr) {
@@ -50,14 +75,31 @@ DartGodotInstanceBinding::~DartGodotInstanceBinding() {
 }
 
 void DartGodotInstanceBinding::delete_dart_handle() {
-  if (_is_weak) {
-    Dart_DeleteWeakPersistentHandle((Dart_WeakPersistentHandle)_persistent_handle);
-  } else {
-    Dart_DeletePersistentHandle((Dart_PersistentHandle)_persistent_handle);
+  if (_weak_handle != nullptr) {
+    Dart_DeleteWeakPersistentHandle(_weak_handle);
+    RuntimeStats::decrement(RuntimeCounter::WeakPersistentHandles);
+  }
+  Dart_DeletePersistentHandle(_persistent_handle);
+  RuntimeStats::decrement(RuntimeCounter::PersistentHandles);
+}
+
+void DartGodotInstanceBinding::release_dart_handles() {
+  if (_persistent_handle == nullptr) {
+    return;
   }
+
+  delete_dart_handle();
+  _persistent_handle = nullptr;
+  _weak_handle = nullptr;
+  _is_weak = false;
+  _handles_dead.store(false, std::memory_order_release);
 }
 
 void DartGodotInstanceBinding::initialize(Dart_Handle dart_object, bool is_refcounted) {
+  // Replacing a collected Dart object. Its reference to the Godot object is
+  // still released by the DeferredDestroyQueue, only its handles go now.
+  release_dart_handles();
+
   s_instanceMap[(intptr_t)this] = this;
   _is_refcounted = is_refcounted;
 
@@ -66,7 +108,10 @@ void DartGodotInstanceBinding::initialize(Dart_Handle dart_object, bool is_refco
 
     // Create our initial handle weak before calling init_ref, which may callback into reference
     _is_weak = true;
-    _persistent_handle = (void *)Dart_NewWeakPersistentHandle(dart_object, this, 0, gde_weak_finalizer);
+    _weak_handle = Dart_NewWeakPersistentHandle(dart_object, this, 0, gde_weak_finalizer);
+    _persistent_handle = Dart_NewPersistentHandle(Dart_Null());
+    RuntimeStats::increment(RuntimeCounter::WeakPersistentHandles);
+    RuntimeStats::increment(RuntimeCounter::PersistentHandles);
     ref_counted.init_ref();
 
     int32_t count = ref_counted.get_reference_count();
@@ -77,7 +122,8 @@ void DartGodotInstanceBinding::initialize(Dart_Handle dart_object, bool is_refco
   } else {
     // Not refcounted, always hold strong
     _is_weak = false;
-    _persistent_handle = (void *)Dart_NewPersistentHandle(dart_object);
+    _persistent_handle = Dart_NewPersistentHandle(dart_object);
+    RuntimeStats::increment(RuntimeCounter::PersistentHandles);
   }
 }
 
@@ -86,49 +132,58 @@ Dart_Handle DartGodotInstanceBinding::get_dart_object() {
     create_dart_object();
   }
 
-  if (_is_weak) {
-    return Dart_HandleFromWeakPersistent((Dart_WeakPersistentHandle)_persistent_handle);
+  if (_weak_handle != nullptr) {
+    // Valid whether we're holding strong or weak
+    return Dart_HandleFromWeakPersistent(_weak_handle);
   }
 
-  return Dart_HandleFromPersistent((Dart_PersistentHandle)_persistent_handle);
+  return Dart_HandleFromPersistent(_persistent_handle);
 }
 
 bool DartGodotInstanceBinding::convert_to_strong() {
+  if (!is_initialized()) return false;
   if (!_is_weak) return true;
 
+  CrossingTraceScope trace(CrossingKind::RefChange);
   DartBlockScope scope;
 
-  Dart_Handle object = Dart_HandleFromWeakPersistent((Dart_WeakPersistentHandle)_persistent_handle);
+  Dart_Handle object = Dart_HandleFromWeakPersistent(_weak_handle);
   if (Dart_IsNull(object)) {
     return false;
   }
-  Dart_PersistentHandle strong_handle = Dart_NewPersistentHandle(object);
-  Dart_DeleteWeakPersistentHandle((Dart_WeakPersistentHandle)_persistent_handle);
-
-  _persistent_handle = strong_handle;
+  Dart_SetPersistentHandle(_persistent_handle, object);
   _is_weak = false;
 
   return true;
 }
 
 bool DartGodotInstanceBinding::convert_to_weak() {
+  if (!is_initialized()) return false;
   if (_is_weak) return true;
 
-  DartBlockScope scope;
+  CrossingTraceScope trace(CrossingKind::RefChange);
 
-  Dart_Handle object = Dart_HandleFromPersistent((Dart_PersistentHandle)_persistent_handle);
-  if (Dart_IsNull(object)) {
-    return false;
-  }
-  Dart_WeakPersistentHandle weak_handle = Dart_NewWeakPersistentHandle(object, this, 0, gde_weak_finalizer);
-  Dart_DeletePersistentHandle((Dart_PersistentHandle)_persistent_handle);
-
-  _persistent_handle = weak_handle;
+  // Dropping the strong root is all that's needed, the weak handle still
+  // tracks the object and will finalize it.
+  Dart_SetPersistentHandle(_persistent_handle, Dart_Null());
   _is_weak = true;
 
   return true;
 }
 
+void DartGodotInstanceBinding::reset() {
+  if (_persistent_handle == nullptr) {
+    return;
+  }
+
+  release_dart_handles();
+
+  GodotDartBindings *bindings = GodotDartBindings::instance();
+  if (bindings != nullptr) {
+    bindings->remove_pending_ref_change(this);
+  }
+}
+
 void DartGodotInstanceBinding::create_dart_object() {
   GodotDartBindings *bindings = GodotDartBindings::instance();
   if (!bindings && _godot_object != nullptr) {
@@ -184,8 +239,8 @@ static void __engine_binding_free_callback(void *p_token, void *p_instance, void
     return;
   }
 
-  if (binding->is_weak() || bindings->_is_stopping) {
-    // If the binding is weak or we're shutting down, there's a possibility Dart is asking us
+  if (binding->is_weak() || !binding->is_initialized() || bindings->_is_stopping) {
+    // If the binding is weak, has no Dart object, or we're shutting down, there's a possibility Dart is asking us
     // to kill this in a way that does not allow us to call back into any other Dart code other
     // than deleting the reference. So just do that and be done with it.
     delete binding;
@@ -218,11 +273,15 @@ static GDExtensionBool __engine_binding_reference_callback(void *p_token, void *
 
   DartGodotInstanceBinding *engine_binding = reinterpret_cast<DartGodotInstanceBinding *>(p_instance);
   godot::Object *godot_object = reinterpret_cast<godot::Object *>(engine_binding->get_godot_object());
-  assert(engine_binding->is_initialized());
 
   RefCountedWrapper ref_counted(godot_object);
   int refcount = ref_counted.get_reference_count();
 
+  if (!engine_binding->is_initialized()) {
+    // No Dart object (yet, or since a reset), so nothing to hold on to
+    return refcount == 0;
+  }
+
   bool is_dieing = refcount == 0;
   if (bindings->_is_stopping) {
     return is_dieing;
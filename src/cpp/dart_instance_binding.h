@@ -1,23 +1,29 @@
 #pragma once
 
+#include <atomic>
 #include <dart_api.h>
 #include <map>
 
 #include "gdextension_interface.h"
 
 // Because Godot has us switching between strong and weak
-// persitent handles, encapsulate that into a custom GC handle
+// persitent handles, encapsulate that into a custom GC handle.
+//
+// RefCounted objects get both a weak handle (which owns the finalizer) and a
+// strong handle, allocated once. Holding strong just points the strong handle
+// at the object, and holding weak points it at null, so toggling never
+// allocates or frees VM handles.
 class DartGodotInstanceBinding {
 public:
-  DartGodotInstanceBinding(Dart_PersistentHandle dart_type_info, GDExtensionObjectPtr godot_object)
-      : _is_refcounted(false), _is_weak(false), _persistent_handle(nullptr), _godot_object(godot_object),
-        _dart_type_info(dart_type_info) {
-  }
+  DartGodotInstanceBinding(Dart_PersistentHandle dart_type_info, GDExtensionObjectPtr godot_object);
 
   ~DartGodotInstanceBinding();
 
+  // False while the binding's Dart object has been collected but
+  // DeferredDestroyQueue hasn't released its reference yet, so the next
+  // get_dart_object creates a new one.
   bool is_initialized() const {
-    return _persistent_handle != nullptr;
+    return _persistent_handle != nullptr && !_handles_dead.load(std::memory_order_acquire);
   }
   bool is_weak() const {
     return _is_weak;
@@ -35,19 +41,35 @@ public:
   void create_dart_object();
   bool convert_to_strong();
   bool convert_to_weak();
+  // Drop the handles to a Dart object that has been collected while the
+  // Godot object lives on. Must be called from the Dart thread.
+  void reset();
 
   static GDExtensionInstanceBindingCallbacks engine_binding_callbacks;
 
   static std::map<intptr_t, DartGodotInstanceBinding *> s_instanceMap;
 
 private:
+  friend class DeferredDestroyQueue;
+
   void delete_dart_handle();
+  void release_dart_handles();
 
   bool _is_refcounted;
   bool _is_weak;
-  void *_persistent_handle;
+  // Always created. Points to null while the binding is weak.
+  Dart_PersistentHandle _persistent_handle;
+  // Only created for RefCounted objects
+  Dart_WeakPersistentHandle _weak_handle;
   GDExtensionObjectPtr _godot_object;
   Dart_PersistentHandle _dart_type_info;
+  // Set by the finalizer when the weak handle's object is collected
+  std::atomic<bool> _handles_dead;
+  // References held by collected Dart objects, waiting for the
+  // DeferredDestroyQueue to release them. The binding is linked into the
+  // queue while this is non-zero.
+  std::atomic<uint32_t> _pending_unreferences;
+  DartGodotInstanceBinding *_next_pending_destroy;
 };
 
 void gde_weak_finalizer(void *isolate_callback_data, void *peer);
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include "dart_memory_notifier.h"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/main_loop.hpp>
+#include <godot_cpp/classes/scene_tree.hpp>
+#include <godot_cpp/classes/window.hpp>
+
+#include "dart_bindings.h"
+
+void DartMemoryNotifier::_bind_methods() {
+}
+
+void DartMemoryNotifier::_notification(int p_what) {
+  switch (p_what) {
+  case godot::MainLoop::NOTIFICATION_OS_MEMORY_WARNING:
+  case godot::MainLoop::NOTIFICATION_APPLICATION_PAUSED: {
+    GodotDartBindings *bindings = GodotDartBindings::instance();
+    if (bindings != nullptr) {
+      bindings->notify_low_memory();
+    }
+  } break;
+  default:
+    break;
+  }
+}
+
+bool DartMemoryNotifier::attach() {
+  godot::SceneTree *tree = godot::Object::cast_to<godot::SceneTree>(godot::Engine::get_singleton()->get_main_loop());
+  if (tree == nullptr || tree->get_root() == nullptr) {
+    return false;
+  }
+
+  DartMemoryNotifier *notifier = memnew(DartMemoryNotifier);
+  notifier->set_name("DartMemoryNotifier");
+  // Deferred, as the tree may be in the middle of processing
+  tree->get_root()->call_deferred("add_child", notifier, false, godot::Node::INTERNAL_MODE_BACK);
+  return true;
+}
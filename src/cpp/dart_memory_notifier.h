@@ -0,0 +1,21 @@
+#pragma once
+
+#include <godot_cpp/classes/node.hpp>
+
+// Internal node added to the SceneTree's root so the Dart VM hears about
+// memory pressure. SceneTree propagates OS memory warnings and application
+// pause notifications to every node, and this forwards them to
+// Dart_NotifyLowMemory.
+class DartMemoryNotifier : public godot::Node {
+  GDCLASS(DartMemoryNotifier, godot::Node);
+
+public:
+  void _notification(int p_what);
+
+  // Adds a notifier to the current SceneTree if there is one. Returns false
+  // if there's no tree to attach to yet.
+  static bool attach();
+
+protected:
+  static void _bind_methods();
+};
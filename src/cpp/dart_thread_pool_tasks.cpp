@@ -0,0 +1,248 @@
+#include "dart_thread_pool_tasks.h"
+
+#include <algorithm>
+#include <string>
+
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/godot.hpp>
+#include <godot_cpp/variant/callable.hpp>
+#include <godot_cpp/variant/variant.hpp>
+
+#include "dart_helpers.h"
+#include "dart_worker_pool.h"
+#include "gde_wrapper.h"
+
+static thread_local void *t_thread_isolate = nullptr;
+
+static bool dart_string_to_std(Dart_Handle dart_string, std::string *r_string) {
+  const char *cstring = nullptr;
+  if (Dart_IsError(dart_string) || Dart_IsError(Dart_StringToCString(dart_string, &cstring))) {
+    return false;
+  }
+  *r_string = cstring;
+  return true;
+}
+
+DartThreadPoolTasks *DartThreadPoolTasks::instance() {
+  static DartThreadPoolTasks tasks;
+  return &tasks;
+}
+
+int64_t DartThreadPoolTasks::add_task(Dart_Handle task, int64_t buffer_address, int64_t buffer_length,
+                                      bool high_priority, const godot::String &description) {
+  godot::Callable callable;
+  if (!create_task_callable(task, 1, 1, buffer_address, buffer_length, &callable)) {
+    return -1;
+  }
+  return godot::WorkerThreadPool::get_singleton()->add_task(callable, high_priority, description);
+}
+
+int64_t DartThreadPoolTasks::add_group_task(Dart_Handle task, int64_t element_count, int64_t batch_size,
+                                            int32_t tasks_needed, int64_t buffer_address, int64_t buffer_length,
+                                            bool high_priority, const godot::String &description) {
+  element_count = std::max<int64_t>(element_count, 0);
+  batch_size = std::max<int64_t>(batch_size, 1);
+  godot::Callable callable;
+  if (!create_task_callable(task, element_count, batch_size, buffer_address, buffer_length, &callable)) {
+    return -1;
+  }
+
+  int64_t batches = (element_count + batch_size - 1) / batch_size;
+  return godot::WorkerThreadPool::get_singleton()->add_group_task(callable, static_cast<int32_t>(batches),
+                                                                  tasks_needed, high_priority, description);
+}
+
+void DartThreadPoolTasks::thread_exit() {
+  ThreadIsolate *thread_isolate = reinterpret_cast<ThreadIsolate *>(t_thread_isolate);
+  if (thread_isolate == nullptr) {
+    return;
+  }
+  t_thread_isolate = nullptr;
+
+  std::lock_guard<std::mutex> lock(_lock);
+  {
+    std::lock_guard<std::mutex> isolate_lock(thread_isolate->lock);
+    if (thread_isolate->isolate != nullptr) {
+      Dart_EnterIsolate(thread_isolate->isolate);
+      Dart_ShutdownIsolate();
+      thread_isolate->isolate = nullptr;
+    }
+  }
+  auto itr = std::find_if(_thread_isolates.begin(), _thread_isolates.end(),
+                          [&](const auto &entry) { return entry.get() == thread_isolate; });
+  if (itr != _thread_isolates.end()) {
+    _thread_isolates.erase(itr);
+  }
+}
+
+void DartThreadPoolTasks::shutdown() {
+  _shutting_down = true;
+
+  // The entries themselves are freed when their thread exits, as the thread
+  // still points to them
+  std::lock_guard<std::mutex> lock(_lock);
+  for (const auto &thread_isolate : _thread_isolates) {
+    std::lock_guard<std::mutex> isolate_lock(thread_isolate->lock);
+    if (thread_isolate->isolate != nullptr) {
+      Dart_EnterIsolate(thread_isolate->isolate);
+      Dart_ShutdownIsolate();
+      thread_isolate->isolate = nullptr;
+    }
+  }
+}
+
+bool DartThreadPoolTasks::create_task_callable(Dart_Handle task, int64_t element_count, int64_t batch_size,
+                                               int64_t buffer_address, int64_t buffer_length,
+                                               godot::Callable *r_callable) {
+  Task *native_task = new Task();
+  if (!resolve_task(task, native_task)) {
+    delete native_task;
+    return false;
+  }
+  native_task->element_count = element_count;
+  native_task->batch_size = batch_size;
+  native_task->buffer_address = buffer_address;
+  native_task->buffer_length = buffer_length;
+
+  // Freed by free_task when Godot releases the callable
+  GDExtensionCallableCustomInfo2 info = {};
+  info.callable_userdata = native_task;
+  info.token = GDEWrapper::instance()->get_library_ptr();
+  info.call_func = call_task;
+  info.free_func = free_task;
+  godot::internal::gdextension_interface_callable_custom_create2(r_callable->_native_ptr(), &info);
+
+  return true;
+}
+
+bool DartThreadPoolTasks::resolve_task(Dart_Handle task, Task *r_task) {
+  if (!Dart_IsClosure(task)) {
+    return false;
+  }
+
+  Dart_Handle function = Dart_ClosureFunction(task);
+  bool is_static = false;
+  if (Dart_IsError(function) || Dart_IsError(Dart_FunctionIsStatic(function, &is_static)) || !is_static) {
+    return false;
+  }
+
+  // The owner of a static method is its class, and of a top-level function
+  // its library
+  Dart_Handle owner = Dart_FunctionOwner(function);
+  Dart_Handle library = owner;
+  if (Dart_IsType(owner)) {
+    if (!dart_string_to_std(Dart_ClassName(owner), &r_task->class_name)) {
+      return false;
+    }
+    library = Dart_ClassLibrary(owner);
+  }
+  if (!dart_string_to_std(Dart_LibraryUrl(library), &r_task->library_url) ||
+      !dart_string_to_std(Dart_FunctionName(function), &r_task->function_name)) {
+    return false;
+  }
+
+  // Closures declared inside static functions are static as well, but can't
+  // be found by name. Make sure this one can.
+  Dart_Handle tear_off = Dart_GetField(owner, Dart_NewStringFromCString(r_task->function_name.c_str()));
+  return !Dart_IsError(tear_off) && Dart_IsClosure(tear_off);
+}
+
+void DartThreadPoolTasks::call_task(void *callable_userdata, const GDExtensionConstVariantPtr *p_args,
+                                    GDExtensionInt p_argument_count, GDExtensionVariantPtr r_return,
+                                    GDExtensionCallError *r_error) {
+  const Task *task = reinterpret_cast<const Task *>(callable_userdata);
+
+  // Group tasks are passed the index of the batch to run
+  int64_t batch = 0;
+  if (p_argument_count > 0) {
+    batch = *reinterpret_cast<const godot::Variant *>(p_args[0]);
+  }
+  instance()->run(*task, batch);
+
+  *r_error = GDExtensionCallError{GDEXTENSION_CALL_OK, 0, 0};
+}
+
+void DartThreadPoolTasks::free_task(void *callable_userdata) {
+  delete reinterpret_cast<Task *>(callable_userdata);
+}
+
+void DartThreadPoolTasks::invoke_task(const Task &task, int64_t start, int64_t end) {
+  DartBlockScope scope;
+
+  DART_CHECK(library, Dart_LookupLibrary(Dart_NewStringFromCString(task.library_url.c_str())),
+             "Could not find thread pool task library");
+  Dart_Handle target = library;
+  if (!task.class_name.empty()) {
+    target = Dart_GetClass(library, Dart_NewStringFromCString(task.class_name.c_str()));
+  }
+  DART_CHECK(function, Dart_GetField(target, Dart_NewStringFromCString(task.function_name.c_str())),
+             "Could not find thread pool task");
+
+  DART_CHECK(godot_dart_library,
+             Dart_LookupLibrary(Dart_NewStringFromCString("package:godot_dart/godot_dart.dart")),
+             "Could not find the `godot_dart` package");
+  Dart_Handle args[] = {
+      function,
+      Dart_NewInteger(start),
+      Dart_NewInteger(end),
+      Dart_NewInteger(task.buffer_address),
+      Dart_NewInteger(task.buffer_length),
+  };
+  DART_CHECK(result, Dart_Invoke(godot_dart_library, Dart_NewStringFromCString("_runThreadPoolTask"), 5, args),
+             "Error running thread pool task");
+}
+
+void DartThreadPoolTasks::run(const Task &task, int64_t batch) {
+  int64_t start = batch * task.batch_size;
+  int64_t end = std::min(task.element_count, start + task.batch_size);
+  if (start >= end || _shutting_down) {
+    return;
+  }
+
+  // A thread waiting on a task can be asked to run tasks itself. If it's
+  // already in an isolate (likely the main isolate, waiting from Dart), the
+  // task can run there just as well.
+  if (Dart_CurrentIsolate() != nullptr) {
+    invoke_task(task, start, end);
+    return;
+  }
+
+  ThreadIsolate *thread_isolate = get_thread_isolate();
+  if (thread_isolate == nullptr) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(thread_isolate->lock);
+  if (thread_isolate->isolate == nullptr) {
+    return;
+  }
+  Dart_EnterIsolate(thread_isolate->isolate);
+  invoke_task(task, start, end);
+  Dart_ExitIsolate();
+}
+
+DartThreadPoolTasks::ThreadIsolate *DartThreadPoolTasks::get_thread_isolate() {
+  ThreadIsolate *thread_isolate = reinterpret_cast<ThreadIsolate *>(t_thread_isolate);
+  if (thread_isolate != nullptr) {
+    return thread_isolate;
+  }
+
+  std::lock_guard<std::mutex> lock(_lock);
+  if (_shutting_down) {
+    return nullptr;
+  }
+
+  std::string name = "godot_dart_thread_" + std::to_string(_thread_isolates.size());
+  Dart_Isolate isolate = DartWorkerPool::instance()->create_helper_isolate(name.c_str());
+  if (isolate == nullptr) {
+    return nullptr;
+  }
+
+  auto entry = std::make_unique<ThreadIsolate>();
+  entry->isolate = isolate;
+  thread_isolate = entry.get();
+  _thread_isolates.push_back(std::move(entry));
+  t_thread_isolate = thread_isolate;
+
+  return thread_isolate;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <dart_api.h>
+#include <gdextension_interface.h>
+#include <godot_cpp/variant/callable.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+// Runs Dart functions as tasks on Godot's WorkerThreadPool, so Dart work
+// shares the engine's scheduler instead of competing with it for cores.
+//
+// Each pool thread runs its tasks in a helper isolate from the main isolate's
+// group, created the first time the thread runs a Dart task and shut down
+// when the thread exits. Since the task has to be found again in the helper
+// isolate, it must be a top-level or static function. It's invoked through
+// `_runThreadPoolTask` in godot_dart.dart.
+class DartThreadPoolTasks {
+public:
+  static DartThreadPoolTasks *instance();
+
+  // Must be called from the Dart thread. Returns the WorkerThreadPool task
+  // id, or -1 if `task` isn't a top-level or static function.
+  int64_t add_task(Dart_Handle task, int64_t buffer_address, int64_t buffer_length, bool high_priority,
+                   const godot::String &description);
+  // Split [0, element_count) into batches of `batch_size` elements and add a
+  // group task with one element per batch. Returns the WorkerThreadPool group
+  // id, or -1 if `task` isn't a top-level or static function.
+  int64_t add_group_task(Dart_Handle task, int64_t element_count, int64_t batch_size, int32_t tasks_needed,
+                         int64_t buffer_address, int64_t buffer_length, bool high_priority,
+                         const godot::String &description);
+
+  // Called from DartScriptLanguage::_thread_exit. Shuts down this thread's
+  // helper isolate if it has one.
+  void thread_exit();
+
+  // Shut down every helper isolate, waiting for tasks that are running on
+  // them. Tasks that start afterwards do nothing.
+  void shutdown();
+
+private:
+  DartThreadPoolTasks() = default;
+
+  struct Task {
+    std::string library_url;
+    // Empty for top-level functions
+    std::string class_name;
+    std::string function_name;
+    int64_t element_count = 1;
+    int64_t batch_size = 1;
+    int64_t buffer_address = 0;
+    int64_t buffer_length = 0;
+  };
+
+  struct ThreadIsolate {
+    // Held while a task runs, so shutdown can't pull the isolate out from
+    // under it
+    std::mutex lock;
+    Dart_Isolate isolate = nullptr;
+  };
+
+  static bool create_task_callable(Dart_Handle task, int64_t element_count, int64_t batch_size,
+                                   int64_t buffer_address, int64_t buffer_length, godot::Callable *r_callable);
+  static bool resolve_task(Dart_Handle task, Task *r_task);
+  static void call_task(void *callable_userdata, const GDExtensionConstVariantPtr *p_args,
+                        GDExtensionInt p_argument_count, GDExtensionVariantPtr r_return,
+                        GDExtensionCallError *r_error);
+  static void free_task(void *callable_userdata);
+  static void invoke_task(const Task &task, int64_t start, int64_t end);
+
+  void run(const Task &task, int64_t batch);
+  ThreadIsolate *get_thread_isolate();
+
+  std::mutex _lock;
+  std::vector<std::unique_ptr<ThreadIsolate>> _thread_isolates;
+  std::atomic<bool> _shutting_down = false;
+};
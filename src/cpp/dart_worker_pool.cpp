@@ -0,0 +1,191 @@
+#include "dart_worker_pool.h"
+
+#include <cstdlib>
+#include <string>
+
+#include "dart_helpers.h"
+#include "runtime_stats.h"
+
+DartWorkerPool *DartWorkerPool::instance() {
+  static DartWorkerPool pool;
+  return &pool;
+}
+
+bool DartWorkerPool::start(Dart_Isolate main_isolate, int32_t worker_count) {
+  _seed_isolate = create_isolate(main_isolate, "godot_dart_seed");
+  if (_seed_isolate == nullptr) {
+    return false;
+  }
+  Dart_ExitIsolate();
+
+  _worker_count = worker_count;
+  return true;
+}
+
+void DartWorkerPool::start_workers() {
+  // Each worker creates its own isolate on its own thread, as the caller is
+  // in the main isolate and can't create one here
+  for (int32_t i = 0; i < _worker_count; ++i) {
+    auto worker = std::make_unique<Worker>();
+    worker->port = worker->port_promise.get_future().share();
+    worker->thread = std::thread(&DartWorkerPool::run_worker, this, worker.get(), i);
+    _workers.push_back(std::move(worker));
+  }
+}
+
+void DartWorkerPool::stop() {
+  // Any message that isn't a job tells the worker to close its port, which
+  // ends its run loop
+  for (const auto &worker : _workers) {
+    Dart_Port port = worker->port.get();
+    if (port != ILLEGAL_PORT) {
+      Dart_PostInteger(port, 0);
+    }
+  }
+  for (const auto &worker : _workers) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+  _workers.clear();
+  RuntimeStats::set(RuntimeCounter::WorkerJobs, 0);
+
+  std::lock_guard<std::mutex> lock(_seed_lock);
+  if (_seed_isolate != nullptr) {
+    Dart_EnterIsolate(_seed_isolate);
+    Dart_ShutdownIsolate();
+    _seed_isolate = nullptr;
+  }
+}
+
+Dart_Isolate DartWorkerPool::create_helper_isolate(const char *name) {
+  std::lock_guard<std::mutex> lock(_seed_lock);
+  if (_seed_isolate == nullptr) {
+    return nullptr;
+  }
+
+  Dart_Isolate isolate = create_isolate(_seed_isolate, name);
+  if (isolate != nullptr) {
+    Dart_ExitIsolate();
+  }
+  return isolate;
+}
+
+int32_t DartWorkerPool::acquire() {
+  std::call_once(_workers_started, [this] { start_workers(); });
+
+  int32_t best = -1;
+  int32_t best_in_flight = INT32_MAX;
+  for (size_t i = 0; i < _workers.size(); ++i) {
+    int32_t in_flight = _workers[i]->in_flight.load(std::memory_order_relaxed);
+    if (in_flight < best_in_flight) {
+      best = static_cast<int32_t>(i);
+      best_in_flight = in_flight;
+    }
+  }
+
+  if (best >= 0) {
+    _workers[best]->in_flight.fetch_add(1, std::memory_order_relaxed);
+    RuntimeStats::increment(RuntimeCounter::WorkerJobs);
+  }
+  return best;
+}
+
+void DartWorkerPool::release(int32_t worker) {
+  if (worker < 0 || worker >= get_worker_count()) {
+    return;
+  }
+  _workers[worker]->in_flight.fetch_sub(1, std::memory_order_relaxed);
+  RuntimeStats::decrement(RuntimeCounter::WorkerJobs);
+}
+
+Dart_Port DartWorkerPool::get_port(int32_t worker) const {
+  if (worker < 0 || worker >= get_worker_count()) {
+    return ILLEGAL_PORT;
+  }
+  return _workers[worker]->port.get();
+}
+
+Dart_Isolate DartWorkerPool::create_isolate(Dart_Isolate group_member, const char *name) {
+  char *error = nullptr;
+  Dart_Isolate isolate = Dart_CreateIsolateInGroup(group_member, name, nullptr, nullptr, nullptr, &error);
+  if (isolate == nullptr) {
+    GD_PRINT_ERROR("GodotDart: Failed to create isolate: ");
+    GD_PRINT_ERROR(error);
+    free(error);
+    return nullptr;
+  }
+
+  // The new isolate is current on return. Statics aren't shared between
+  // isolates, so prints need to be redirected to Godot again.
+  DartBlockScope scope;
+  Dart_Handle godot_dart_library = Dart_LookupLibrary(Dart_NewStringFromCString("package:godot_dart/godot_dart.dart"));
+  Dart_Handle internal_lib = Dart_LookupLibrary(Dart_NewStringFromCString("dart:_internal"));
+  if (!Dart_IsError(godot_dart_library) && !Dart_IsError(internal_lib)) {
+    Dart_Handle print = Dart_Invoke(godot_dart_library, Dart_NewStringFromCString("_getPrintClosure"), 0, nullptr);
+    Dart_SetField(internal_lib, Dart_NewStringFromCString("_printClosure"), print);
+  }
+
+  return isolate;
+}
+
+Dart_Isolate DartWorkerPool::create_worker_isolate(Dart_Isolate group_member, int32_t index, Dart_Port *r_port) {
+  std::string name = "godot_dart_worker_" + std::to_string(index);
+  Dart_Isolate isolate = create_isolate(group_member, name.c_str());
+  if (isolate == nullptr) {
+    return nullptr;
+  }
+
+  *r_port = ILLEGAL_PORT;
+  {
+    DartBlockScope scope;
+
+    Dart_Handle godot_dart_library = Dart_LookupLibrary(Dart_NewStringFromCString("package:godot_dart/godot_dart.dart"));
+    if (!Dart_IsError(godot_dart_library)) {
+      Dart_Handle args[] = {Dart_NewInteger(index)};
+      Dart_Handle result = Dart_Invoke(godot_dart_library, Dart_NewStringFromCString("_workerMain"), 1, args);
+      if (Dart_IsError(result)) {
+        GD_PRINT_ERROR("GodotDart: Error calling `_workerMain`: ");
+        GD_PRINT_ERROR(Dart_GetError(result));
+      } else {
+        Dart_IntegerToInt64(result, r_port);
+      }
+    }
+  }
+
+  if (*r_port == ILLEGAL_PORT) {
+    Dart_ShutdownIsolate();
+    return nullptr;
+  }
+
+  Dart_ExitIsolate();
+  return isolate;
+}
+
+void DartWorkerPool::run_worker(Worker *worker, int32_t index) {
+  Dart_Port port = ILLEGAL_PORT;
+  Dart_Isolate isolate = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(_seed_lock);
+    if (_seed_isolate != nullptr) {
+      isolate = create_worker_isolate(_seed_isolate, index, &port);
+    }
+  }
+  worker->port_promise.set_value(port);
+  if (isolate == nullptr) {
+    return;
+  }
+
+  Dart_EnterIsolate(isolate);
+  {
+    DartBlockScope scope;
+
+    // Runs until the worker closes its port
+    Dart_Handle result = Dart_RunLoop();
+    if (Dart_IsError(result)) {
+      GD_PRINT_ERROR("GodotDart: Worker isolate exited with an error: ");
+      GD_PRINT_ERROR(Dart_GetError(result));
+    }
+  }
+  Dart_ShutdownIsolate();
+}
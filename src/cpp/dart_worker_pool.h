@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <dart_api.h>
+
+// Background isolates in the same isolate group as the main isolate, so Dart
+// code can run CPU heavy jobs on other cores.
+//
+// Workers are started on first use, so games that never run a job don't pay
+// for their isolates and threads. Each worker is created from the main
+// isolate's program and runs its message loop on its own thread. Jobs are closures sent from the main isolate to a
+// worker's port (see worker_pool.dart), which is possible because the workers
+// share the main isolate's group. Native buffers are passed as raw addresses,
+// so nothing is copied, and results come back on a port owned by the main
+// isolate, which is serviced during frame maintenance.
+//
+// Workers don't have access to Godot. They can only touch the buffers they're
+// given.
+class DartWorkerPool {
+public:
+  static DartWorkerPool *instance();
+
+  // Create the seed isolate in the group of `main_isolate`, which workers and
+  // create_helper_isolate create their isolates from. `worker_count` workers
+  // are started by the first acquire. Must be called with no current isolate
+  // and while no other thread has entered `main_isolate`. Returns false if the
+  // seed couldn't be created.
+  bool start(Dart_Isolate main_isolate, int32_t worker_count);
+  // Close every worker's port and wait for its thread to exit. Jobs that are
+  // already running are allowed to finish.
+  void stop();
+
+  // Create another isolate in the main isolate's group, from any thread
+  // without a current isolate. The isolate is not entered on return. Returns
+  // nullptr if the pool isn't running.
+  Dart_Isolate create_helper_isolate(const char *name);
+
+  int32_t get_worker_count() const {
+    return static_cast<int32_t>(_workers.size());
+  }
+  // Choose the worker with the fewest jobs in flight and count a job against
+  // it, starting the workers if this is the first job. Returns -1 if there
+  // are no workers.
+  int32_t acquire();
+  // Called when a job acquired from `worker` has delivered its result
+  void release(int32_t worker);
+  // Waits for `worker` to finish starting. Returns ILLEGAL_PORT if it
+  // couldn't.
+  Dart_Port get_port(int32_t worker) const;
+
+private:
+  DartWorkerPool() = default;
+
+  struct Worker {
+    // Set by the worker's thread once its isolate is listening
+    std::promise<Dart_Port> port_promise;
+    std::shared_future<Dart_Port> port;
+    std::atomic<int32_t> in_flight = 0;
+    std::thread thread;
+  };
+
+  static Dart_Isolate create_isolate(Dart_Isolate group_member, const char *name);
+  static Dart_Isolate create_worker_isolate(Dart_Isolate group_member, int32_t index, Dart_Port *r_port);
+  void start_workers();
+  void run_worker(Worker *worker, int32_t index);
+
+  int32_t _worker_count = 0;
+  std::once_flag _workers_started;
+  std::vector<std::unique_ptr<Worker>> _workers;
+  // Never runs any code. Creating an isolate in a group requires a member
+  // isolate that no other thread is in, which the main isolate can't promise.
+  Dart_Isolate _seed_isolate = nullptr;
+  std::mutex _seed_lock;
+};
@@ -0,0 +1,136 @@
+#include "deferred_destroy_queue.h"
+
+#include <godot_cpp/classes/time.hpp>
+
+#include "dart_instance_binding.h"
+#include "gde_c_interface.h"
+#include "ref_counted_wrapper.h"
+#include "runtime_stats.h"
+
+DeferredDestroyQueue *DeferredDestroyQueue::instance() {
+  static DeferredDestroyQueue queue;
+  return &queue;
+}
+
+DeferredDestroyQueue::DeferredDestroyQueue() : _slots(new Slot[kCapacity]) {
+  for (size_t i = 0; i < kCapacity; ++i) {
+    _slots[i].sequence.store(i, std::memory_order_relaxed);
+    _slots[i].object = nullptr;
+  }
+}
+
+bool DeferredDestroyQueue::push(GDExtensionObjectPtr object) {
+  size_t index = _push_index.load(std::memory_order_relaxed);
+  while (true) {
+    Slot &slot = _slots[index % kCapacity];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(index);
+    if (diff == 0) {
+      if (_push_index.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) {
+        slot.object = object;
+        slot.sequence.store(index + 1, std::memory_order_release);
+        break;
+      }
+    } else if (diff < 0) {
+      // Still holds an object from a full lap ago
+      return false;
+    } else {
+      index = _push_index.load(std::memory_order_relaxed);
+    }
+  }
+
+  RuntimeStats::increment(RuntimeCounter::PendingDestroys);
+  return true;
+}
+
+bool DeferredDestroyQueue::pop(GDExtensionObjectPtr *r_object) {
+  Slot &slot = _slots[_pop_index % kCapacity];
+  size_t sequence = slot.sequence.load(std::memory_order_acquire);
+  if (sequence != _pop_index + 1) {
+    return false;
+  }
+
+  *r_object = slot.object;
+  slot.sequence.store(_pop_index + kCapacity, std::memory_order_release);
+  _pop_index++;
+  return true;
+}
+
+void DeferredDestroyQueue::push_unreference(DartGodotInstanceBinding *binding) {
+  // Already queued, process releases every pending reference at once
+  if (binding->_pending_unreferences.fetch_add(1, std::memory_order_acq_rel) > 0) {
+    return;
+  }
+
+  binding->_next_pending_destroy = _incoming_unreferences.load(std::memory_order_relaxed);
+  while (!_incoming_unreferences.compare_exchange_weak(binding->_next_pending_destroy, binding,
+                                                       std::memory_order_release, std::memory_order_relaxed)) {
+  }
+  RuntimeStats::increment(RuntimeCounter::PendingDestroys);
+}
+
+size_t DeferredDestroyQueue::process(uint64_t budget_usec) {
+  GDExtensionObjectPtr object = nullptr;
+  while (pop(&object)) {
+    _backlog.push_back(Entry{object, nullptr});
+  }
+
+  // Incoming unreferences are a stack, reverse it so objects are released in
+  // the order they were pushed
+  DartGodotInstanceBinding *incoming = _incoming_unreferences.exchange(nullptr, std::memory_order_acquire);
+  DartGodotInstanceBinding *reversed = nullptr;
+  while (incoming != nullptr) {
+    DartGodotInstanceBinding *next = incoming->_next_pending_destroy;
+    incoming->_next_pending_destroy = reversed;
+    reversed = incoming;
+    incoming = next;
+  }
+  while (reversed != nullptr) {
+    DartGodotInstanceBinding *next = reversed->_next_pending_destroy;
+    reversed->_next_pending_destroy = nullptr;
+    _backlog.push_back(Entry{reversed->get_godot_object(), reversed});
+    reversed = next;
+  }
+
+  godot::Time *time = godot::Time::get_singleton();
+  uint64_t start = time->get_ticks_usec();
+  while (!_backlog.empty()) {
+    Entry entry = _backlog.front();
+    _backlog.pop_front();
+
+    destroy(entry);
+    RuntimeStats::decrement(RuntimeCounter::PendingDestroys);
+
+    if (budget_usec > 0 && time->get_ticks_usec() - start >= budget_usec) {
+      break;
+    }
+  }
+
+  return _backlog.size();
+}
+
+void DeferredDestroyQueue::destroy(const Entry &entry) {
+  if (entry.binding == nullptr) {
+    gde_object_destroy(entry.object);
+    return;
+  }
+
+  DartGodotInstanceBinding *binding = entry.binding;
+  uint32_t count = binding->_pending_unreferences.exchange(0, std::memory_order_acq_rel);
+  RefCountedWrapper ref_counted(entry.object);
+  for (; count > 0; --count) {
+    if (ref_counted.unreference()) {
+      // Frees the binding along with the object
+      gde_object_destroy(entry.object);
+      return;
+    }
+  }
+
+  // Godot picked up a new reference since the finalizer ran (from the
+  // ResourceCache, say). If Dart hasn't asked for the object again, drop the
+  // dead handles. Otherwise the binding already holds a new Dart object,
+  // which keeps its own reference.
+  if (binding->_handles_dead.load(std::memory_order_acquire)) {
+    binding->reset();
+  }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include <gdextension_interface.h>
+
+class DartGodotInstanceBinding;
+
+// Godot objects released by Dart finalizers. Finalizers run during GC, and
+// destroying an object there (particularly a Resource that owns GPU data) can
+// make the GC pause much longer. Instead, finalizers push the object here
+// (lock free, without allocating), and frame maintenance destroys them on the
+// Dart thread within a time budget, spreading large frees over several frames.
+class DeferredDestroyQueue {
+public:
+  // Objects that can be pushed between two calls to process
+  static const size_t kCapacity = 16 * 1024;
+
+  static DeferredDestroyQueue *instance();
+
+  // Queue `object` to be destroyed. Safe to call from any thread, including
+  // finalizers. Returns false if the queue is full, in which case the caller
+  // has to destroy the object itself.
+  bool push(GDExtensionObjectPtr object);
+  // Queue Dart's reference to the RefCounted object of `binding`, whose Dart
+  // object has been collected, to be released. The binding itself links it
+  // into the queue, and counts repeat pushes while it's queued, so this can't
+  // fail. Safe to call from any thread, including finalizers.
+  void push_unreference(DartGodotInstanceBinding *binding);
+
+  // Destroy queued objects until `budget_usec` has elapsed. A budget of 0
+  // destroys everything. Returns the number of objects still queued.
+  size_t process(uint64_t budget_usec);
+
+private:
+  DeferredDestroyQueue();
+
+  // A bounded MPSC ring. A slot's sequence is its index when it's free to
+  // push to, and index + 1 once it holds an object.
+  struct Slot {
+    std::atomic<size_t> sequence;
+    GDExtensionObjectPtr object;
+  };
+
+  struct Entry {
+    GDExtensionObjectPtr object;
+    // Set if Dart's reference should be released, rather than the object
+    // destroyed outright
+    DartGodotInstanceBinding *binding;
+  };
+
+  bool pop(GDExtensionObjectPtr *r_object);
+  void destroy(const Entry &entry);
+
+  std::unique_ptr<Slot[]> _slots;
+  std::atomic<size_t> _push_index = 0;
+  // Only touched from process
+  size_t _pop_index = 0;
+
+  std::atomic<DartGodotInstanceBinding *> _incoming_unreferences = nullptr;
+  // Only touched from process, in the order objects were pushed
+  std::deque<Entry> _backlog;
+};
@@ -0,0 +1,136 @@
+#include "deferred_signal_queue.h"
+
+#include <utility>
+
+#include <godot_cpp/godot.hpp>
+
+#include "crossing_trace.h"
+#include "dart_bindings.h"
+#include "dart_helpers.h"
+#include "runtime_stats.h"
+
+static const size_t kInitialCapacity = 64;
+
+bool DartSignalCallable::call(const GDExtensionConstVariantPtr *args, GDExtensionInt count) {
+  GodotDartBindings *bindings = GodotDartBindings::instance();
+  DartBlockScope scope;
+
+  Dart_Handle dart_signal = Dart_HandleFromPersistent(signal);
+  if (trace_name_id == 0 && CrossingTrace::is_enabled()) {
+    trace_name_id = CrossingTrace::instance()->intern_name(CrossingTrace::get_dart_name(dart_signal));
+  }
+  CrossingTraceScope trace(CrossingKind::Signal, trace_name_id);
+  Dart_Handle convert_args[] = {Dart_NewInteger(int64_t(args)), Dart_NewInteger(count)};
+  DART_CHECK_RET(
+      signal_args,
+      Dart_Invoke(bindings->_native_library, Dart_NewStringFromCString("_variantsToDartVariants"), 2, convert_args),
+      false, "Failed to convert variants to Dart.");
+
+  Dart_Handle call_args[] = {signal_args};
+  Dart_Handle result = Dart_Invoke(dart_signal, Dart_NewStringFromCString("call"), 1, call_args);
+  if (Dart_IsError(result)) {
+    GD_PRINT_ERROR("GodotDart: Error performing signal call: ");
+    GD_PRINT_ERROR(Dart_GetError(result));
+    return false;
+  }
+  return true;
+}
+
+void DartSignalCallable::release() {
+  DartBlockScope scope;
+
+  Dart_Handle dart_signal = Dart_HandleFromPersistent(signal);
+  Dart_Invoke(dart_signal, Dart_NewStringFromCString("clear"), 0, nullptr);
+
+  Dart_DeletePersistentHandle(signal);
+  signal = nullptr;
+  RuntimeStats::decrement(RuntimeCounter::PersistentHandles);
+}
+
+DeferredSignalQueue *DeferredSignalQueue::instance() {
+  static DeferredSignalQueue queue;
+  return &queue;
+}
+
+void DeferredSignalQueue::push_call(DartSignalCallable *signal, const GDExtensionConstVariantPtr *args,
+                                    GDExtensionInt argument_count) {
+  std::lock_guard<std::mutex> lock(_lock);
+  Entry &entry = push_entry();
+  entry.signal = signal;
+  entry.free = false;
+  entry.args.clear();
+  for (GDExtensionInt i = 0; i < argument_count; ++i) {
+    entry.args.push_back(*reinterpret_cast<const godot::Variant *>(args[i]));
+  }
+}
+
+void DeferredSignalQueue::push_free(DartSignalCallable *signal) {
+  std::lock_guard<std::mutex> lock(_lock);
+  Entry &entry = push_entry();
+  entry.signal = signal;
+  entry.free = true;
+  entry.args.clear();
+}
+
+size_t DeferredSignalQueue::dispatch() {
+  size_t count = 0;
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_count == 0) {
+      return 0;
+    }
+
+    // Swap rather than copy, so the arguments aren't copied a second time.
+    // The ring gets back the emptied entries from the last dispatch, so their
+    // argument vectors are reused rather than reallocated.
+    count = _count;
+    if (_dispatching.size() < count) {
+      _dispatching.resize(count);
+    }
+    for (size_t i = 0; i < count; ++i) {
+      std::swap(_dispatching[i], _ring[(_head + i) % _ring.size()]);
+    }
+    _head = 0;
+    _count = 0;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    Entry &entry = _dispatching[i];
+    if (entry.free) {
+      entry.signal->release();
+      delete entry.signal;
+    } else if (entry.signal->object_id != 0 &&
+               godot::internal::gdextension_interface_object_get_instance_from_id(entry.signal->object_id) == nullptr) {
+      // The object went away while the call was queued
+    } else {
+      _arg_ptrs.clear();
+      for (const godot::Variant &arg : entry.args) {
+        _arg_ptrs.push_back(&arg);
+      }
+      entry.signal->call(_arg_ptrs.data(), static_cast<GDExtensionInt>(_arg_ptrs.size()));
+    }
+    entry.signal = nullptr;
+    entry.args.clear();
+    RuntimeStats::decrement(RuntimeCounter::PendingSignals);
+  }
+
+  return count;
+}
+
+DeferredSignalQueue::Entry &DeferredSignalQueue::push_entry() {
+  if (_count == _ring.size()) {
+    grow();
+  }
+  RuntimeStats::increment(RuntimeCounter::PendingSignals);
+  return _ring[(_head + _count++) % _ring.size()];
+}
+
+void DeferredSignalQueue::grow() {
+  size_t capacity = _ring.empty() ? kInitialCapacity : _ring.size() * 2;
+  std::vector<Entry> ring(capacity);
+  for (size_t i = 0; i < _count; ++i) {
+    ring[i] = std::move(_ring[(_head + i) % _ring.size()]);
+  }
+  _ring = std::move(ring);
+  _head = 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <dart_api.h>
+#include <gdextension_interface.h>
+#include <godot_cpp/variant/variant.hpp>
+
+// Userdata for the custom Callables created for Dart SignalCallables
+struct DartSignalCallable {
+  Dart_PersistentHandle signal = nullptr;
+  // SignalCallable.arguments is final, so it's read once when the Callable is
+  // created instead of calling into Dart every time Godot asks
+  int64_t argument_count = 0;
+  // The object the signal is connected for, if any. Queued calls are dropped
+  // if it's freed before they're delivered, as Godot does for its own deferred
+  // calls.
+  GDObjectInstanceID object_id = 0;
+  // Calls from threads other than the main thread are queued for the next
+  // frame rather than waiting for the isolate
+  bool deferred = false;
+  // Looked up the first time the signal is called while tracing crossings
+  uint32_t trace_name_id = 0;
+
+  // Both must be called on the Dart thread
+  bool call(const GDExtensionConstVariantPtr *args, GDExtensionInt argument_count);
+  // Clears the SignalCallable and releases its handle
+  void release();
+};
+
+// Signal calls for deferred DartSignalCallables made off the main thread, and
+// frees for all DartSignalCallables. The arguments are copied into a ring
+// buffer, which grows instead of blocking when full, and delivered in order
+// during frame maintenance, so threads emitting signals never wait on Dart.
+class DeferredSignalQueue {
+public:
+  static DeferredSignalQueue *instance();
+
+  void push_call(DartSignalCallable *signal, const GDExtensionConstVariantPtr *args,
+                 GDExtensionInt argument_count);
+  // Freed after any calls to `signal` that are already queued
+  void push_free(DartSignalCallable *signal);
+
+  // Must be called on the Dart thread. Returns the number of entries
+  // delivered, including calls dropped because their object was freed.
+  size_t dispatch();
+
+private:
+  DeferredSignalQueue() = default;
+
+  struct Entry {
+    DartSignalCallable *signal = nullptr;
+    bool free = false;
+    // Kept between uses so the ring doesn't reallocate for each call
+    std::vector<godot::Variant> args;
+  };
+
+  Entry &push_entry();
+  void grow();
+
+  std::mutex _lock;
+  std::vector<Entry> _ring;
+  size_t _head = 0;
+  size_t _count = 0;
+  // Only touched by dispatch. Never shrinks, the emptied entries are swapped
+  // back into the ring on the next dispatch.
+  std::vector<Entry> _dispatching;
+  std::vector<GDExtensionConstVariantPtr> _arg_ptrs;
+};
@@ -309,6 +309,20 @@ void gde_object_method_bind_ptrcall(GDExtensionMethodBindPtr p_method_bind, GDEx
   }
 }
 
+void gde_object_method_bind_ptrcall_batch(GDExtensionMethodBindPtr p_method_bind,
+                                          const GDExtensionObjectPtr *p_instances, GDExtensionInt p_count,
+                                          const GDExtensionConstTypePtr *p_args, GDExtensionInt p_arg_stride,
+                                          const GDExtensionTypePtr *r_rets) {
+  if (!_object_method_bind_ptrcall_func) {
+    return;
+  }
+  for (GDExtensionInt i = 0; i < p_count; ++i) {
+    const GDExtensionConstTypePtr *args = p_arg_stride > 0 ? p_args + i * p_arg_stride : nullptr;
+    GDExtensionTypePtr ret = r_rets != nullptr ? r_rets[i] : nullptr;
+    _object_method_bind_ptrcall_func(p_method_bind, p_instances[i], args, ret);
+  }
+}
+
 static GDExtensionInterfaceObjectGetInstanceBinding _object_get_instance_binding_func = nullptr;
 void *gde_object_get_instance_binding(GDExtensionObjectPtr p_o, void *p_token,
                                       const GDExtensionInstanceBindingCallbacks *p_callbacks) {
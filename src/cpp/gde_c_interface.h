@@ -98,6 +98,13 @@ GDE_EXPORT void gde_object_method_bind_call(GDExtensionMethodBindPtr p_method_bi
                                             GDExtensionUninitializedVariantPtr r_ret, GDExtensionCallError *r_error);
 GDE_EXPORT void gde_object_method_bind_ptrcall(GDExtensionMethodBindPtr p_method_bind, GDExtensionObjectPtr p_instance,
                                                const GDExtensionConstTypePtr *p_args, GDExtensionTypePtr r_ret);
+// Calls the method on each of `p_count` instances. The arguments for instance `i`
+// start at `p_args[i * p_arg_stride]`, and its return value is written to
+// `r_rets[i]`. `r_rets` can be null for methods that return nothing.
+GDE_EXPORT void gde_object_method_bind_ptrcall_batch(GDExtensionMethodBindPtr p_method_bind,
+                                                     const GDExtensionObjectPtr *p_instances, GDExtensionInt p_count,
+                                                     const GDExtensionConstTypePtr *p_args,
+                                                     GDExtensionInt p_arg_stride, const GDExtensionTypePtr *r_rets);
 GDE_EXPORT void *gde_object_get_instance_binding(GDExtensionObjectPtr p_o, void *p_token,
                                                  const GDExtensionInstanceBindingCallbacks *p_callbacks);
 GDE_EXPORT void gde_object_set_instance_binding(GDExtensionObjectPtr p_o, void *p_token, void *p_binding,
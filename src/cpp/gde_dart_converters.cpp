@@ -1,5 +1,7 @@
 #include "gde_dart_converters.h"
 
+#include <string.h>
+
 #include <dart_api.h>
 
 #include "dart_bindings.h"
@@ -105,61 +107,193 @@ void gde_free_arg_list(GDExtensionPropertyInfo *arg_list, uint32_t arg_count) {
 }
 
 void gde_property_info_from_dart(Dart_Handle dart_property_info, GDExtensionPropertyInfo *prop_info) {
-  if (Dart_IsNull(dart_property_info)) {
+  bool read = false;
+  bool allocated = false;
+  if (!Dart_IsNull(dart_property_info)) {
+    read = gde_read_descriptor(dart_property_info, [&](TypeDescriptorReader &reader) {
+      reader.read_property_info(prop_info);
+      allocated = true;
+    });
+  }
+
+  if (!read) {
+    // A malformed descriptor still allocated every field
+    if (allocated) {
+      gde_free_property_info_fields(prop_info);
+    }
     *prop_info = {
         GDEXTENSION_VARIANT_TYPE_NIL, new godot::StringName(), new godot::StringName(), 0, new godot::String(), 0,
     };
-    return;
   }
-  GodotDartBindings *gde = GodotDartBindings::instance();
+}
 
-  DART_CHECK(dart_prop_type, Dart_GetField(dart_property_info, Dart_NewStringFromCString("type")),
-             "Failed to get type info");
-  Dart_Handle dart_type_info = gde->get_dart_type_info_by_type(dart_prop_type);
-  if (Dart_IsNull(dart_type_info)) {
-    GD_PRINT_ERROR("Failed to get typeInfo from propery type.");
-    return;
+// Only use for freeing propery info fiels made with gde_property_info_from_dart
+void gde_free_property_info_fields(GDExtensionPropertyInfo *prop_info) {
+  if (prop_info->name) {
+    delete reinterpret_cast<godot::StringName *>(prop_info->name);
   }
+  if (prop_info->class_name) {
+    delete reinterpret_cast<godot::StringName *>(prop_info->class_name);
+  }
+  if (prop_info->hint_string) {
+    delete reinterpret_cast<godot::String *>(prop_info->hint_string);
+  }
+}
 
-  DART_CHECK(dart_variant_type, Dart_GetField(dart_type_info, Dart_NewStringFromCString("variantType")),
-             "Failed to get variantType");
-  int64_t temp;
-  Dart_IntegerToInt64(dart_variant_type, &temp);
-  prop_info->type = static_cast<GDExtensionVariantType>(temp);
+uint8_t TypeDescriptorReader::read_uint8() {
+  if (!_valid || _offset + 1 > _length) {
+    _valid = false;
+    return 0;
+  }
 
-  DART_CHECK(class_name, Dart_GetField(dart_type_info, Dart_NewStringFromCString("className")),
-             "Failed to get className!");
-  prop_info->class_name = get_object_address(class_name);
+  return _data[_offset++];
+}
 
-  DART_CHECK(dart_name, Dart_GetField(dart_property_info, Dart_NewStringFromCString("name")), "Failed to get name");
-  godot::StringName *name = create_godot_string_name_ptr(dart_name);
-  prop_info->name = name;
+uint32_t TypeDescriptorReader::read_uint32() {
+  if (!_valid || _offset + intptr_t(sizeof(uint32_t)) > _length) {
+    _valid = false;
+    return 0;
+  }
 
-  DART_CHECK(dart_property_hint, Dart_GetField(dart_property_info, Dart_NewStringFromCString("hint")),
-             "Failed to get hint");
-  DART_CHECK(dart_hint_value, Dart_GetField(dart_property_hint, Dart_NewStringFromCString("value")),
-             "Failed to get PropertyHint.value");
-  uint64_t hint = 0;
-  Dart_IntegerToUint64(dart_hint_value, &hint);
-  prop_info->hint = uint32_t(hint);
+  // Buffer is only byte aligned
+  uint32_t value;
+  memcpy(&value, _data + _offset, sizeof(uint32_t));
+  _offset += sizeof(uint32_t);
+  return value;
+}
 
-  DART_CHECK(dart_hint_string, Dart_GetField(dart_property_info, Dart_NewStringFromCString("hintString")),
-             "Failed to get hint string");
-  godot::String *hint_string = create_godot_string_ptr(dart_hint_string);
-  prop_info->hint_string = hint_string;
+godot::String TypeDescriptorReader::read_string() {
+  uint32_t length = read_uint32();
+  if (!_valid || _offset + intptr_t(length) > _length) {
+    _valid = false;
+    return godot::String();
+  }
 
-  DART_CHECK(dart_flags, Dart_GetField(dart_property_info, Dart_NewStringFromCString("flags")), "Failed to get flags");
-  uint64_t flags = 0;
-  Dart_IntegerToUint64(dart_flags, &flags);
-  prop_info->usage = uint32_t(flags);
+  godot::String value = godot::String::utf8(reinterpret_cast<const char *>(_data + _offset), length);
+  _offset += length;
+  return value;
 }
 
-// Only use for freeing propery info fiels made with gde_property_info_from_dart
-void gde_free_property_info_fields(GDExtensionPropertyInfo *prop_info) {
-  if (prop_info->name) {
-    delete reinterpret_cast<godot::StringName *>(prop_info->name);
+void TypeDescriptorReader::read_property_info(GDExtensionPropertyInfo *prop_info) {
+  if (read_uint8() != 0) {
+    prop_info->type = static_cast<GDExtensionVariantType>(read_uint32());
+    prop_info->class_name = new godot::StringName(read_string());
+  } else {
+    if (_valid) {
+      GD_PRINT_ERROR("GodotDart: Failed to get typeInfo from property type");
+    }
+    prop_info->type = GDEXTENSION_VARIANT_TYPE_NIL;
+    prop_info->class_name = new godot::StringName();
   }
-  if (prop_info->hint_string) {
-    delete reinterpret_cast<godot::String *>(prop_info->hint_string);
+  prop_info->name = new godot::StringName(read_string());
+  prop_info->hint = read_uint32();
+  prop_info->hint_string = new godot::String(read_string());
+  prop_info->usage = read_uint32();
+}
+
+godot::Dictionary TypeDescriptorReader::read_property_dict() {
+  // Same keys as PropertyInfo.asDict
+  static const godot::StringName type_key("type", true);
+  static const godot::StringName name_key("name", true);
+  static const godot::StringName class_name_key("class_name", true);
+  static const godot::StringName hint_key("hint", true);
+  static const godot::StringName hint_string_key("hint_string", true);
+  static const godot::StringName usage_key("usage", true);
+
+  godot::Dictionary dict;
+  bool has_type_info = read_uint8() != 0;
+  if (!has_type_info) {
+    // asDict left properties with no type info empty. Skip the rest of it.
+    read_string();
+    read_uint32();
+    read_string();
+    read_uint32();
+    return dict;
+  }
+
+  dict[type_key] = read_uint32();
+  dict[class_name_key] = godot::StringName(read_string());
+  dict[name_key] = read_string();
+  dict[hint_key] = read_uint32();
+  dict[hint_string_key] = read_string();
+  dict[usage_key] = read_uint32();
+  return dict;
+}
+
+godot::Array TypeDescriptorReader::read_property_dict_list() {
+  godot::Array list;
+  uint32_t count = read_uint32();
+  for (uint32_t i = 0; i < count && _valid; ++i) {
+    list.append(read_property_dict());
+  }
+  return list;
+}
+
+godot::Dictionary TypeDescriptorReader::read_method_dict() {
+  // Same keys as MethodInfo.asDict
+  static const godot::StringName name_key("name", true);
+  static const godot::StringName flags_key("flags", true);
+  static const godot::StringName return_key("return", true);
+  static const godot::StringName args_key("args", true);
+
+  godot::Dictionary dict;
+  dict[name_key] = read_string();
+  dict[flags_key] = read_uint32();
+  if (read_uint8() != 0) {
+    dict[return_key] = read_property_dict();
+  }
+  dict[args_key] = read_property_dict_list();
+  return dict;
+}
+
+godot::Dictionary TypeDescriptorReader::read_signal_dict() {
+  // Same keys as SignalInfo.asDict
+  static const godot::StringName name_key("name", true);
+  static const godot::StringName flags_key("flags", true);
+  static const godot::StringName args_key("args", true);
+
+  godot::Dictionary dict;
+  dict[name_key] = read_string();
+  dict[flags_key] = read_uint32();
+  dict[args_key] = read_property_dict_list();
+  return dict;
+}
+
+godot::Dictionary TypeDescriptorReader::read_rpc_dict() {
+  // Same keys as RpcInfo.asDict
+  static const godot::StringName name_key("name", true);
+  static const godot::StringName rpc_mode_key("rpc_mode", true);
+  static const godot::StringName call_local_key("call_local", true);
+  static const godot::StringName transfer_mode_key("transfer_mode", true);
+  static const godot::StringName channel_key("channel", true);
+
+  godot::Dictionary dict;
+  dict[name_key] = read_string();
+  dict[rpc_mode_key] = read_uint32();
+  dict[call_local_key] = read_uint8() != 0;
+  dict[transfer_mode_key] = read_uint32();
+  dict[channel_key] = read_uint32();
+  return dict;
+}
+
+bool gde_read_descriptor(Dart_Handle dart_object, const std::function<void(TypeDescriptorReader &)> &read) {
+  DART_CHECK_RET(descriptor, Dart_Invoke(dart_object, Dart_NewStringFromCString("toDescriptor"), 0, nullptr), false,
+                 "Failed to get type descriptor");
+
+  Dart_TypedData_Type data_type;
+  void *data = nullptr;
+  intptr_t length = 0;
+  DART_CHECK_RET(acquire_result, Dart_TypedDataAcquireData(descriptor, &data_type, &data, &length), false,
+                 "Failed to acquire type descriptor data");
+
+  TypeDescriptorReader reader(reinterpret_cast<const uint8_t *>(data), length);
+  read(reader);
+
+  Dart_TypedDataReleaseData(descriptor);
+
+  if (!reader.is_valid()) {
+    GD_PRINT_ERROR("GodotDart: Malformed type descriptor");
+    return false;
   }
+  return true;
 }
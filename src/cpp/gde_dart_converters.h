@@ -1,8 +1,13 @@
 #pragma once
 
+#include <functional>
+
 #include <gdextension_interface.h>
 
 #include <dart_api.h>
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/string.hpp>
 
 struct TypeInfo {
   GDExtensionStringNamePtr type_name = nullptr;
@@ -25,4 +30,44 @@ void gde_free_arg_list(GDExtensionPropertyInfo *arg_list, uint32_t arg_count);
 void gde_free_method_info_fields(GDExtensionMethodInfo *method_info);
 
 void gde_property_info_from_dart(Dart_Handle dart_property_info, GDExtensionPropertyInfo *prop_info);
-void gde_free_property_info_fields(GDExtensionPropertyInfo *prop_info);
\ No newline at end of file
+void gde_free_property_info_fields(GDExtensionPropertyInfo *prop_info);
+
+// Must match `typeDescriptorVersion` in type_descriptor.dart
+#define TYPE_DESCRIPTOR_VERSION 2
+
+// Reads the flat buffers written by `TypeDescriptorWriter` (see type_descriptor.dart
+// for the layout). Reading past the end of the buffer marks the reader invalid and
+// returns zeroed values rather than reading out of bounds.
+class TypeDescriptorReader {
+public:
+  TypeDescriptorReader(const uint8_t *data, intptr_t length) : _data(data), _length(length), _offset(0), _valid(true) {
+  }
+
+  bool is_valid() const {
+    return _valid;
+  }
+
+  uint8_t read_uint8();
+  uint32_t read_uint32();
+  godot::String read_string();
+
+  // Fields are allocated, free with gde_free_property_info_fields
+  void read_property_info(GDExtensionPropertyInfo *prop_info);
+  godot::Dictionary read_property_dict();
+  godot::Dictionary read_method_dict();
+  godot::Dictionary read_signal_dict();
+  godot::Dictionary read_rpc_dict();
+
+private:
+  godot::Array read_property_dict_list();
+
+  const uint8_t *_data;
+  intptr_t _length;
+  intptr_t _offset;
+  bool _valid;
+};
+
+// Calls `toDescriptor` on `dart_object` and hands a reader over the result to `read`.
+// The Dart buffer is acquired for the duration of `read`, so `read` must not call
+// into Dart. Returns false if the descriptor couldn't be retrieved or was malformed.
+bool gde_read_descriptor(Dart_Handle dart_object, const std::function<void(TypeDescriptorReader &)> &read);
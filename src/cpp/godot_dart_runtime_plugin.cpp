@@ -1,18 +1,24 @@
 #include "godot_dart_runtime_plugin.h"
 
+#include <algorithm>
 #include <sstream>
 
 #include <godot_cpp/classes/dir_access.hpp>
 #include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/json.hpp>
 #include <godot_cpp/classes/object.hpp>
+#include <godot_cpp/classes/os.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
 #include <godot_cpp/classes/resource_loader.hpp>
 #include <godot_cpp/classes/resource_saver.hpp>
 
 #include "dart_helpers.h"
+#include "dart_memory_notifier.h"
 #include "gde_wrapper.h"
 #include "godot_string_wrappers.h"
 #include "ref_counted_wrapper.h"
+#include "runtime_stats.h"
 
 #include "script/dart_resource_format.h"
 #include "script/dart_script_instance.h"
@@ -20,7 +26,9 @@
 
 GodotDartRuntimePlugin *GodotDartRuntimePlugin::s_instance = nullptr;
 
-GodotDartRuntimePlugin::GodotDartRuntimePlugin() : _dart_bindings(nullptr), _root_dart_dir() {
+GodotDartRuntimePlugin::GodotDartRuntimePlugin()
+    : _dart_bindings(nullptr), _root_dart_dir(), _boot_snapshot_searched(false), _boot_snapshot(),
+      _kernel_cache_key() {
   assert(s_instance == nullptr);
   s_instance = this;
 }
@@ -32,6 +40,7 @@ void GodotDartRuntimePlugin::base_init() {
   godot::ClassDB::register_class<DartScript>();
   godot::ClassDB::register_class<DartResourceFormatLoader>();
   godot::ClassDB::register_class<DartResourceFormatSaver>();
+  godot::ClassDB::register_class<DartMemoryNotifier>();
 
   godot::String library_path;
   gde_get_library_path(gde->get_library_ptr(), library_path._native_ptr());
@@ -60,13 +69,49 @@ void GodotDartRuntimePlugin::base_init() {
   godot::ResourceLoader::get_singleton()->add_resource_format_loader(_resource_format_loader);
   godot::ResourceSaver::get_singleton()->add_resource_format_saver(_resource_format_saver);
 
+  register_project_settings();
+
   godot::Engine::get_singleton()->register_script_language(DartScriptLanguage::instance());
+  RuntimeStats::register_monitors(DartScriptLanguage::instance(), "get_runtime_counter");
+  RuntimeStats::register_crossing_monitors(DartScriptLanguage::instance(), "get_crossing_count",
+                                           "get_crossing_time_msec");
 
-  if (has_dart_module() && has_package_config()) {
+  if ((has_dart_module() && has_package_config()) || !find_boot_snapshot().empty()) {
     initialize_dart_bindings();
   }
 }
 
+static void register_setting(const char *setting, const godot::Variant &default_value, godot::PropertyHint hint,
+                             const char *hint_string) {
+  godot::ProjectSettings *project_settings = godot::ProjectSettings::get_singleton();
+  if (!project_settings->has_setting(setting)) {
+    project_settings->set_setting(setting, default_value);
+  }
+  project_settings->set_initial_value(setting, default_value);
+
+  godot::Dictionary property_info;
+  property_info["name"] = setting;
+  property_info["type"] = default_value.get_type();
+  property_info["hint"] = hint;
+  property_info["hint_string"] = hint_string;
+  project_settings->add_property_info(property_info);
+}
+
+static void register_int_setting(const char *setting, int64_t default_value, const char *hint_string) {
+  register_setting(setting, default_value, godot::PROPERTY_HINT_RANGE, hint_string);
+}
+
+void GodotDartRuntimePlugin::register_project_settings() {
+  register_int_setting(DART_SETTING_OLD_GEN_HEAP_MB, 0, "0,65536,1,or_greater,suffix:MB");
+  register_int_setting(DART_SETTING_NEW_GEN_SEMI_MB, 0, "0,65536,1,or_greater,suffix:MB");
+  register_int_setting(DART_SETTING_DESTROY_BUDGET_USEC, DART_DEFAULT_DESTROY_BUDGET_USEC,
+                       "0,100000,1,or_greater,suffix:usec");
+  register_int_setting(DART_SETTING_WORKER_ISOLATES, DART_DEFAULT_WORKER_ISOLATES, "-1,64,1");
+  register_setting(DART_SETTING_TRACE_CROSSINGS, false, godot::PROPERTY_HINT_NONE, "");
+  register_setting(DART_SETTING_TRACE_PATH, DART_DEFAULT_TRACE_PATH, godot::PROPERTY_HINT_NONE, "");
+  register_setting(DART_SETTING_CROSSING_STATS, true, godot::PROPERTY_HINT_NONE, "");
+}
+
 bool GodotDartRuntimePlugin::has_dart_module() const {
   // Looking for src/pubspec.yaml and src/main.dart. If both are there, we're probably good.
   // We'll check for the package config later
@@ -105,15 +150,249 @@ bool GodotDartRuntimePlugin::has_package_config() const {
   return true;
 }
 
+// Collects the path of every Dart source under `dir`, skipping hidden
+// directories (.dart_tool, .git) and build output.
+static void collect_dart_sources(const godot::String &dir, godot::PackedStringArray &paths) {
+  godot::PackedStringArray files = godot::DirAccess::get_files_at(dir);
+  for (int64_t i = 0; i < files.size(); ++i) {
+    if (files[i].get_extension() == "dart") {
+      paths.append(dir.path_join(files[i]));
+    }
+  }
+
+  godot::PackedStringArray dirs = godot::DirAccess::get_directories_at(dir);
+  for (int64_t i = 0; i < dirs.size(); ++i) {
+    if (dirs[i].begins_with(".") || dirs[i] == "build") {
+      continue;
+    }
+    collect_dart_sources(dir.path_join(dirs[i]), paths);
+  }
+}
+
+static bool is_in_pub_cache(const godot::String &path) {
+  godot::String pub_cache = godot::OS::get_singleton()->get_environment("PUB_CACHE").replace("\\", "/");
+  if (!pub_cache.is_empty() && path.begins_with(pub_cache)) {
+    return true;
+  }
+  godot::String lower_path = path.to_lower();
+  return lower_path.contains("/.pub-cache/") || lower_path.contains("/pub/cache/");
+}
+
+// The root directories of the packages in package_config.json that can be
+// edited in place, which are path dependencies. Packages in the pub cache are
+// immutable and pinned by pubspec.lock, so they're left out, as is the root
+// package itself.
+static godot::PackedStringArray get_path_dependency_roots(const godot::String &root_dir) {
+  godot::PackedStringArray roots;
+  godot::String config_dir = root_dir.path_join(".dart_tool");
+  godot::String config_text = godot::FileAccess::get_file_as_string(config_dir.path_join("package_config.json"));
+  if (config_text.is_empty()) {
+    return roots;
+  }
+  godot::Variant config = godot::JSON::parse_string(config_text);
+  if (config.get_type() != godot::Variant::DICTIONARY) {
+    return roots;
+  }
+
+  godot::String simplified_root = root_dir.simplify_path();
+  godot::Array packages = godot::Dictionary(config).get("packages", godot::Array());
+  for (int64_t i = 0; i < packages.size(); ++i) {
+    if (packages[i].get_type() != godot::Variant::DICTIONARY) {
+      continue;
+    }
+    godot::String root_uri = godot::Dictionary(packages[i]).get("rootUri", "");
+    godot::String package_root;
+    if (root_uri.begins_with("file://")) {
+      package_root = root_uri.trim_prefix("file://").uri_decode();
+      // file:///C:/path on Windows
+      if (package_root.substr(2, 1) == ":") {
+        package_root = package_root.substr(1);
+      }
+    } else if (!root_uri.is_empty()) {
+      // Relative to the directory holding package_config.json
+      package_root = config_dir.path_join(root_uri.uri_decode());
+    }
+    package_root = package_root.simplify_path();
+
+    if (package_root.is_empty() || package_root == simplified_root || is_in_pub_cache(package_root) ||
+        !godot::DirAccess::dir_exists_absolute(package_root)) {
+      continue;
+    }
+    roots.append(package_root);
+  }
+
+  return roots;
+}
+
+// Every Dart source in the project and its path dependencies
+static void collect_project_dart_sources(const godot::String &root_dir, godot::PackedStringArray &paths) {
+  collect_dart_sources(root_dir, paths);
+
+  godot::PackedStringArray dependency_roots = get_path_dependency_roots(root_dir);
+  for (int64_t i = 0; i < dependency_roots.size(); ++i) {
+    collect_dart_sources(dependency_roots[i], paths);
+  }
+}
+
+std::string GodotDartRuntimePlugin::find_boot_snapshot() const {
+  if (!_boot_snapshot_searched) {
+    _boot_snapshot = GDEWrapper::instance()->is_editor_hint() ? find_kernel_cache() : find_exported_snapshot();
+    _boot_snapshot_searched = true;
+  }
+  return _boot_snapshot;
+}
+
+std::string GodotDartRuntimePlugin::find_exported_snapshot() const {
+  // Anything the snapshot could have been built from. If any of these are
+  // newer than the snapshot, it's stale and we compile from source instead.
+  static const char *package_files[] = {
+      "pubspec.lock",
+      ".dart_tool/package_config.json",
+  };
+  // Preferred order: AppJIT snapshots skip both compilation and most of the
+  // warmup, kernel snapshots skip compilation only. AOT snapshots can't be
+  // run by the JIT runtime in dart_dll, so they aren't looked for.
+  static const char *snapshot_files[] = {
+      "main.jit",
+      "main.dill",
+  };
+
+  godot::String root_dir(_root_dart_dir.c_str());
+  godot::PackedStringArray sources;
+  for (const char *package_file : package_files) {
+    godot::String path = root_dir.path_join(package_file);
+    if (godot::FileAccess::file_exists(path)) {
+      sources.append(path);
+    }
+  }
+  collect_project_dart_sources(root_dir, sources);
+
+  uint64_t newest_source = 0;
+  for (int64_t i = 0; i < sources.size(); ++i) {
+    newest_source = std::max(newest_source, godot::FileAccess::get_modified_time(sources[i]));
+  }
+
+  for (const char *snapshot_file : snapshot_files) {
+    godot::String path = godot::String(_root_dart_dir.c_str()).path_join(snapshot_file);
+    if (!godot::FileAccess::file_exists(path)) {
+      continue;
+    }
+
+    if (godot::FileAccess::get_modified_time(path) < newest_source) {
+      godot::String message = godot::String("GodotDart: Ignoring stale snapshot ") + path;
+      GD_PRINT_WARNING(message.utf8().get_data());
+      continue;
+    }
+
+    return std::string(path.utf8().get_data());
+  }
+
+  return std::string();
+}
+
+godot::String GodotDartRuntimePlugin::get_kernel_cache_dir() const {
+  return godot::String(_root_dart_dir.c_str()).path_join(".dart_tool/godot_dart");
+}
+
+godot::String GodotDartRuntimePlugin::get_kernel_cache_key() const {
+  if (!_kernel_cache_key.is_empty()) {
+    return _kernel_cache_key;
+  }
+
+  godot::String root_dir(_root_dart_dir.c_str());
+  godot::PackedStringArray entries;
+
+  // Dependencies are keyed by content, since pub rewrites these files even
+  // when nothing changes
+  static const char *package_files[] = {
+      "pubspec.lock",
+      ".dart_tool/package_config.json",
+  };
+  for (const char *package_file : package_files) {
+    godot::String path = root_dir.path_join(package_file);
+    if (godot::FileAccess::file_exists(path)) {
+      entries.append(godot::String(package_file) + ":" + godot::FileAccess::get_md5(path));
+    }
+  }
+
+  godot::PackedStringArray sources;
+  collect_project_dart_sources(root_dir, sources);
+  sources.sort();
+  for (int64_t i = 0; i < sources.size(); ++i) {
+    entries.append(sources[i].trim_prefix(root_dir) + ":" +
+                   godot::String::num_uint64(godot::FileAccess::get_modified_time(sources[i])));
+  }
+
+  _kernel_cache_key = godot::String("\n").join(entries).md5_text();
+  return _kernel_cache_key;
+}
+
+std::string GodotDartRuntimePlugin::find_kernel_cache() const {
+  godot::String cache_dir = get_kernel_cache_dir();
+  godot::String kernel_path = cache_dir.path_join("main.dill");
+  godot::String key_path = cache_dir.path_join("main.dill.key");
+  if (!godot::FileAccess::file_exists(kernel_path) || !godot::FileAccess::file_exists(key_path)) {
+    return std::string();
+  }
+
+  // The key is written before the compile starts, so a kernel older than its
+  // key comes from a compile that failed or never finished.
+  if (godot::FileAccess::get_modified_time(kernel_path) < godot::FileAccess::get_modified_time(key_path)) {
+    return std::string();
+  }
+
+  if (godot::FileAccess::get_file_as_string(key_path) != get_kernel_cache_key()) {
+    return std::string();
+  }
+
+  return std::string(kernel_path.utf8().get_data());
+}
+
+void GodotDartRuntimePlugin::update_kernel_cache() const {
+  godot::String root_dir(_root_dart_dir.c_str());
+  godot::String cache_dir = get_kernel_cache_dir();
+  if (godot::DirAccess::make_dir_recursive_absolute(cache_dir) != godot::OK) {
+    GD_PRINT_WARNING("GodotDart: Could not create the kernel cache directory");
+    return;
+  }
+
+  godot::Ref<godot::FileAccess> key_file =
+      godot::FileAccess::open(cache_dir.path_join("main.dill.key"), godot::FileAccess::WRITE);
+  if (key_file.is_null()) {
+    GD_PRINT_WARNING("GodotDart: Could not write the kernel cache key");
+    return;
+  }
+  key_file->store_string(get_kernel_cache_key());
+  key_file->close();
+
+  // Compile in the background so the editor isn't blocked. The next launch
+  // picks up the result.
+  godot::PackedStringArray args;
+  args.append("compile");
+  args.append("kernel");
+  args.append("--packages=" + root_dir.path_join(".dart_tool/package_config.json"));
+  args.append("--output=" + cache_dir.path_join("main.dill"));
+  args.append(root_dir.path_join("main.dart"));
+  if (godot::OS::get_singleton()->create_process("dart", args) < 0) {
+    GD_PRINT_WARNING("GodotDart: Could not start `dart compile kernel` to update the kernel cache");
+  }
+}
+
 bool GodotDartRuntimePlugin::initialize_dart_bindings() {
   char dart_script_path[256], package_path[256];
   sprintf(dart_script_path, "%s/main.dart", _root_dart_dir.c_str());
   sprintf(package_path, "%s/.dart_tool/package_config.json", _root_dart_dir.c_str());
 
+  std::string snapshot_path = find_boot_snapshot();
+
   _dart_bindings = new GodotDartBindings();
-  if (!_dart_bindings->initialize(dart_script_path, package_path)) {
+  if (!_dart_bindings->initialize(has_dart_module() ? dart_script_path : nullptr,
+                                  has_package_config() ? package_path : nullptr,
+                                  snapshot_path.empty() ? nullptr : snapshot_path.c_str())) {
     delete _dart_bindings;
     _dart_bindings = nullptr;
+  } else if (snapshot_path.empty() && GDEWrapper::instance()->is_editor_hint()) {
+    update_kernel_cache();
   }
 
   return true;
@@ -169,6 +448,7 @@ void GodotDartRuntimePlugin::shutdown_dart_bindings() {
   _resource_format_loader.unref();
   godot::ResourceSaver::get_singleton()->remove_resource_format_saver(_resource_format_saver);
   _resource_format_saver.unref();
+  RuntimeStats::unregister_monitors();
   DartScriptLanguage *language = DartScriptLanguage::instance();
   godot::Engine::get_singleton()->unregister_script_language(language);
   // This will cause the instance to delete itself
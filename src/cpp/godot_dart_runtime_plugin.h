@@ -8,6 +8,7 @@
 // This class wraps the Dart bindings for Godot so we can do the following:
 //   - Detect if a Dart project exists before loading
 //   - Load the Dart project post initialization
+//   - Boot exported games from a precompiled snapshot instead of source
 //   - TODO:
 //   - Load the godot_dart package separately from user code (allows some 
 //     functionality of the extension even if the user code doesn't compile)
@@ -19,6 +20,11 @@ public:
 
   bool has_dart_module() const;
   bool has_package_config() const;
+  // Returns the path to a precompiled kernel (.dill) or AppJIT snapshot that
+  // is newer than the sources it was built from, or an empty string if Dart
+  // should be compiled from source. In the editor this is the kernel cache.
+  // Only searched for once.
+  std::string find_boot_snapshot() const;
 
   const std::string &get_root_dart_dir() const {
     return _root_dart_dir;
@@ -32,10 +38,27 @@ public:
   }
 
 private: 
+  static void register_project_settings();
+
+  // A main.jit or main.dill next to the sources, newer than all of them
+  std::string find_exported_snapshot() const;
+
+  // The editor keeps a kernel of the last successful compile in
+  // .dart_tool/godot_dart, keyed by a hash of the sources (including those of
+  // path dependencies) and package config. The key is computed once per
+  // launch.
+  godot::String get_kernel_cache_dir() const;
+  godot::String get_kernel_cache_key() const;
+  std::string find_kernel_cache() const;
+  void update_kernel_cache() const;
+
   static GodotDartRuntimePlugin *s_instance;
 
   GodotDartBindings *_dart_bindings;
   std::string _root_dart_dir;
+  mutable bool _boot_snapshot_searched;
+  mutable std::string _boot_snapshot;
+  mutable godot::String _kernel_cache_key;
 
   godot::Ref<DartResourceFormatLoader> _resource_format_loader;
   godot::Ref<DartResourceFormatSaver> _resource_format_saver;
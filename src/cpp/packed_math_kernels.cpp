@@ -0,0 +1,344 @@
+#include "packed_math_kernels.h"
+
+// The kernels read and write vectors as plain floats
+static_assert(sizeof(godot::real_t) == sizeof(float), "Packed math kernels require single precision builds");
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PACKED_MATH_SSE 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PACKED_MATH_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(PACKED_MATH_SSE) || defined(PACKED_MATH_NEON)
+#define PACKED_MATH_SIMD 1
+#endif
+
+// A minimal 4 wide float layer over SSE and NEON, just enough for the kernels
+// below. Vectors are loaded as structure of arrays: one register of x, one of
+// y (and one of z) for four consecutive points.
+#if defined(PACKED_MATH_SSE)
+
+typedef __m128 f32x4;
+typedef __m128 mask4;
+
+static inline f32x4 f4_splat(float v) {
+  return _mm_set1_ps(v);
+}
+static inline f32x4 f4_load(const float *p) {
+  return _mm_loadu_ps(p);
+}
+static inline void f4_store(float *p, f32x4 v) {
+  _mm_storeu_ps(p, v);
+}
+static inline f32x4 f4_add(f32x4 a, f32x4 b) {
+  return _mm_add_ps(a, b);
+}
+static inline f32x4 f4_sub(f32x4 a, f32x4 b) {
+  return _mm_sub_ps(a, b);
+}
+static inline f32x4 f4_mul(f32x4 a, f32x4 b) {
+  return _mm_mul_ps(a, b);
+}
+static inline f32x4 f4_div(f32x4 a, f32x4 b) {
+  return _mm_div_ps(a, b);
+}
+static inline f32x4 f4_sqrt(f32x4 a) {
+  return _mm_sqrt_ps(a);
+}
+static inline mask4 f4_ge(f32x4 a, f32x4 b) {
+  return _mm_cmpge_ps(a, b);
+}
+static inline mask4 f4_le(f32x4 a, f32x4 b) {
+  return _mm_cmple_ps(a, b);
+}
+static inline mask4 f4_gt(f32x4 a, f32x4 b) {
+  return _mm_cmpgt_ps(a, b);
+}
+static inline mask4 m4_and(mask4 a, mask4 b) {
+  return _mm_and_ps(a, b);
+}
+// Bit i is set if lane i of the mask is
+static inline int m4_bits(mask4 m) {
+  return _mm_movemask_ps(m);
+}
+// Lanes of `v` where the mask is set, zero elsewhere
+static inline f32x4 f4_select_or_zero(mask4 m, f32x4 v) {
+  return _mm_and_ps(m, v);
+}
+
+static inline void f4_load_xy(const float *p, f32x4 &x, f32x4 &y) {
+  f32x4 a = _mm_loadu_ps(p);
+  f32x4 b = _mm_loadu_ps(p + 4);
+  x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+  y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+static inline void f4_store_xy(float *p, f32x4 x, f32x4 y) {
+  _mm_storeu_ps(p, _mm_unpacklo_ps(x, y));
+  _mm_storeu_ps(p + 4, _mm_unpackhi_ps(x, y));
+}
+
+static inline void f4_load_xyz(const float *p, f32x4 &x, f32x4 &y, f32x4 &z) {
+  // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+  f32x4 a = _mm_loadu_ps(p);
+  f32x4 b = _mm_loadu_ps(p + 4);
+  f32x4 c = _mm_loadu_ps(p + 8);
+  f32x4 xy23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+  x = _mm_shuffle_ps(a, xy23, _MM_SHUFFLE(2, 0, 3, 0));
+  f32x4 y01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+  y = _mm_shuffle_ps(y01, xy23, _MM_SHUFFLE(3, 1, 2, 0));
+  f32x4 z01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+  f32x4 z23 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+  z = _mm_shuffle_ps(z01, z23, _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline void f4_store_xyz(float *p, f32x4 x, f32x4 y, f32x4 z) {
+  f32x4 xy01 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 0, 1, 0));
+  f32x4 zx01 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+  _mm_storeu_ps(p, _mm_shuffle_ps(xy01, zx01, _MM_SHUFFLE(2, 0, 2, 0)));
+  f32x4 yz1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+  f32x4 xy2 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2));
+  _mm_storeu_ps(p + 4, _mm_shuffle_ps(yz1, xy2, _MM_SHUFFLE(2, 0, 2, 0)));
+  f32x4 zx23 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+  f32x4 yz3 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+  _mm_storeu_ps(p + 8, _mm_shuffle_ps(zx23, yz3, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+#elif defined(PACKED_MATH_NEON)
+
+typedef float32x4_t f32x4;
+typedef uint32x4_t mask4;
+
+static inline f32x4 f4_splat(float v) {
+  return vdupq_n_f32(v);
+}
+static inline f32x4 f4_load(const float *p) {
+  return vld1q_f32(p);
+}
+static inline void f4_store(float *p, f32x4 v) {
+  vst1q_f32(p, v);
+}
+static inline f32x4 f4_add(f32x4 a, f32x4 b) {
+  return vaddq_f32(a, b);
+}
+static inline f32x4 f4_sub(f32x4 a, f32x4 b) {
+  return vsubq_f32(a, b);
+}
+static inline f32x4 f4_mul(f32x4 a, f32x4 b) {
+  return vmulq_f32(a, b);
+}
+static inline f32x4 f4_div(f32x4 a, f32x4 b) {
+  return vdivq_f32(a, b);
+}
+static inline f32x4 f4_sqrt(f32x4 a) {
+  return vsqrtq_f32(a);
+}
+static inline mask4 f4_ge(f32x4 a, f32x4 b) {
+  return vcgeq_f32(a, b);
+}
+static inline mask4 f4_le(f32x4 a, f32x4 b) {
+  return vcleq_f32(a, b);
+}
+static inline mask4 f4_gt(f32x4 a, f32x4 b) {
+  return vcgtq_f32(a, b);
+}
+static inline mask4 m4_and(mask4 a, mask4 b) {
+  return vandq_u32(a, b);
+}
+static inline int m4_bits(mask4 m) {
+  static const uint32_t lane_bits[4] = {1, 2, 4, 8};
+  return static_cast<int>(vaddvq_u32(vandq_u32(m, vld1q_u32(lane_bits))));
+}
+static inline f32x4 f4_select_or_zero(mask4 m, f32x4 v) {
+  return vreinterpretq_f32_u32(vandq_u32(m, vreinterpretq_u32_f32(v)));
+}
+
+static inline void f4_load_xy(const float *p, f32x4 &x, f32x4 &y) {
+  float32x4x2_t v = vld2q_f32(p);
+  x = v.val[0];
+  y = v.val[1];
+}
+
+static inline void f4_store_xy(float *p, f32x4 x, f32x4 y) {
+  float32x4x2_t v = {{x, y}};
+  vst2q_f32(p, v);
+}
+
+static inline void f4_load_xyz(const float *p, f32x4 &x, f32x4 &y, f32x4 &z) {
+  float32x4x3_t v = vld3q_f32(p);
+  x = v.val[0];
+  y = v.val[1];
+  z = v.val[2];
+}
+
+static inline void f4_store_xyz(float *p, f32x4 x, f32x4 y, f32x4 z) {
+  float32x4x3_t v = {{x, y, z}};
+  vst3q_f32(p, v);
+}
+
+#endif
+
+void packed_vector2_transform(godot::Vector2 *points, int64_t count, const godot::Transform2D &xform) {
+  int64_t i = 0;
+#if defined(PACKED_MATH_SIMD)
+  const f32x4 c0x = f4_splat(xform.columns[0].x), c0y = f4_splat(xform.columns[0].y);
+  const f32x4 c1x = f4_splat(xform.columns[1].x), c1y = f4_splat(xform.columns[1].y);
+  const f32x4 c2x = f4_splat(xform.columns[2].x), c2y = f4_splat(xform.columns[2].y);
+  for (; i + 4 <= count; i += 4) {
+    float *p = reinterpret_cast<float *>(points + i);
+    f32x4 x, y;
+    f4_load_xy(p, x, y);
+    f32x4 rx = f4_add(f4_add(f4_mul(c0x, x), f4_mul(c1x, y)), c2x);
+    f32x4 ry = f4_add(f4_add(f4_mul(c0y, x), f4_mul(c1y, y)), c2y);
+    f4_store_xy(p, rx, ry);
+  }
+#endif
+  for (; i < count; ++i) {
+    points[i] = xform.xform(points[i]);
+  }
+}
+
+void packed_vector3_transform(godot::Vector3 *points, int64_t count, const godot::Transform3D &xform) {
+  int64_t i = 0;
+#if defined(PACKED_MATH_SIMD)
+  const godot::Vector3 *rows = xform.basis.rows;
+  const f32x4 r0x = f4_splat(rows[0].x), r0y = f4_splat(rows[0].y), r0z = f4_splat(rows[0].z);
+  const f32x4 r1x = f4_splat(rows[1].x), r1y = f4_splat(rows[1].y), r1z = f4_splat(rows[1].z);
+  const f32x4 r2x = f4_splat(rows[2].x), r2y = f4_splat(rows[2].y), r2z = f4_splat(rows[2].z);
+  const f32x4 ox = f4_splat(xform.origin.x), oy = f4_splat(xform.origin.y), oz = f4_splat(xform.origin.z);
+  for (; i + 4 <= count; i += 4) {
+    float *p = reinterpret_cast<float *>(points + i);
+    f32x4 x, y, z;
+    f4_load_xyz(p, x, y, z);
+    f32x4 rx = f4_add(f4_add(f4_add(f4_mul(r0x, x), f4_mul(r0y, y)), f4_mul(r0z, z)), ox);
+    f32x4 ry = f4_add(f4_add(f4_add(f4_mul(r1x, x), f4_mul(r1y, y)), f4_mul(r1z, z)), oy);
+    f32x4 rz = f4_add(f4_add(f4_add(f4_mul(r2x, x), f4_mul(r2y, y)), f4_mul(r2z, z)), oz);
+    f4_store_xyz(p, rx, ry, rz);
+  }
+#endif
+  for (; i < count; ++i) {
+    points[i] = xform.xform(points[i]);
+  }
+}
+
+void packed_float_lerp(float *values, const float *to, int64_t count, float weight) {
+  int64_t i = 0;
+#if defined(PACKED_MATH_SIMD)
+  const f32x4 w = f4_splat(weight);
+  for (; i + 4 <= count; i += 4) {
+    f32x4 from = f4_load(values + i);
+    f4_store(values + i, f4_add(from, f4_mul(f4_sub(f4_load(to + i), from), w)));
+  }
+#endif
+  for (; i < count; ++i) {
+    values[i] = values[i] + (to[i] - values[i]) * weight;
+  }
+}
+
+void packed_vector2_normalize(godot::Vector2 *points, int64_t count) {
+  int64_t i = 0;
+#if defined(PACKED_MATH_SIMD)
+  const f32x4 zero = f4_splat(0.0f);
+  const f32x4 one = f4_splat(1.0f);
+  for (; i + 4 <= count; i += 4) {
+    float *p = reinterpret_cast<float *>(points + i);
+    f32x4 x, y;
+    f4_load_xy(p, x, y);
+    f32x4 length = f4_sqrt(f4_add(f4_mul(x, x), f4_mul(y, y)));
+    f32x4 inv_length = f4_select_or_zero(f4_gt(length, zero), f4_div(one, length));
+    f4_store_xy(p, f4_mul(x, inv_length), f4_mul(y, inv_length));
+  }
+#endif
+  for (; i < count; ++i) {
+    points[i].normalize();
+  }
+}
+
+void packed_vector3_normalize(godot::Vector3 *points, int64_t count) {
+  int64_t i = 0;
+#if defined(PACKED_MATH_SIMD)
+  const f32x4 zero = f4_splat(0.0f);
+  const f32x4 one = f4_splat(1.0f);
+  for (; i + 4 <= count; i += 4) {
+    float *p = reinterpret_cast<float *>(points + i);
+    f32x4 x, y, z;
+    f4_load_xyz(p, x, y, z);
+    f32x4 length = f4_sqrt(f4_add(f4_add(f4_mul(x, x), f4_mul(y, y)), f4_mul(z, z)));
+    f32x4 inv_length = f4_select_or_zero(f4_gt(length, zero), f4_div(one, length));
+    f4_store_xyz(p, f4_mul(x, inv_length), f4_mul(y, inv_length), f4_mul(z, inv_length));
+  }
+#endif
+  for (; i < count; ++i) {
+    points[i].normalize();
+  }
+}
+
+void packed_vector2_distance_to(const godot::Vector2 *points, int64_t count, const godot::Vector2 &point,
+                                float *r_distances) {
+  int64_t i = 0;
+#if defined(PACKED_MATH_SIMD)
+  const f32x4 px = f4_splat(point.x), py = f4_splat(point.y);
+  for (; i + 4 <= count; i += 4) {
+    f32x4 x, y;
+    f4_load_xy(reinterpret_cast<const float *>(points + i), x, y);
+    f32x4 dx = f4_sub(x, px);
+    f32x4 dy = f4_sub(y, py);
+    f4_store(r_distances + i, f4_sqrt(f4_add(f4_mul(dx, dx), f4_mul(dy, dy))));
+  }
+#endif
+  for (; i < count; ++i) {
+    r_distances[i] = points[i].distance_to(point);
+  }
+}
+
+void packed_vector3_distance_to(const godot::Vector3 *points, int64_t count, const godot::Vector3 &point,
+                                float *r_distances) {
+  int64_t i = 0;
+#if defined(PACKED_MATH_SIMD)
+  const f32x4 px = f4_splat(point.x), py = f4_splat(point.y), pz = f4_splat(point.z);
+  for (; i + 4 <= count; i += 4) {
+    f32x4 x, y, z;
+    f4_load_xyz(reinterpret_cast<const float *>(points + i), x, y, z);
+    f32x4 dx = f4_sub(x, px);
+    f32x4 dy = f4_sub(y, py);
+    f32x4 dz = f4_sub(z, pz);
+    f4_store(r_distances + i, f4_sqrt(f4_add(f4_add(f4_mul(dx, dx), f4_mul(dy, dy)), f4_mul(dz, dz))));
+  }
+#endif
+  for (; i < count; ++i) {
+    r_distances[i] = points[i].distance_to(point);
+  }
+}
+
+int64_t packed_vector3_cull_aabb(const godot::Vector3 *points, int64_t count, const godot::AABB &aabb,
+                                 int32_t *r_indices) {
+  int64_t found = 0;
+  int64_t i = 0;
+#if defined(PACKED_MATH_SIMD)
+  const godot::Vector3 end = aabb.position + aabb.size;
+  const f32x4 min_x = f4_splat(aabb.position.x), min_y = f4_splat(aabb.position.y),
+              min_z = f4_splat(aabb.position.z);
+  const f32x4 max_x = f4_splat(end.x), max_y = f4_splat(end.y), max_z = f4_splat(end.z);
+  for (; i + 4 <= count; i += 4) {
+    f32x4 x, y, z;
+    f4_load_xyz(reinterpret_cast<const float *>(points + i), x, y, z);
+    mask4 inside = m4_and(f4_ge(x, min_x), f4_le(x, max_x));
+    inside = m4_and(inside, m4_and(f4_ge(y, min_y), f4_le(y, max_y)));
+    inside = m4_and(inside, m4_and(f4_ge(z, min_z), f4_le(z, max_z)));
+    int bits = m4_bits(inside);
+    for (int lane = 0; bits != 0; ++lane, bits >>= 1) {
+      if (bits & 1) {
+        r_indices[found++] = static_cast<int32_t>(i + lane);
+      }
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    if (aabb.has_point(points[i])) {
+      r_indices[found++] = static_cast<int32_t>(i);
+    }
+  }
+  return found;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+#include <godot_cpp/variant/aabb.hpp>
+#include <godot_cpp/variant/transform2d.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+#include <godot_cpp/variant/vector2.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+// Bulk math over the contents of packed arrays, so Dart can update thousands
+// of points with one native call instead of one Vector per element.
+//
+// The kernels are vectorized four points at a time with SSE on x86-64 and
+// NEON on ARM64, chosen at compile time, and fall back to Godot's own scalar
+// math for the remainder (or everywhere on other targets). Results match the
+// scalar Godot methods, up to float rounding.
+
+// points[i] = xform.xform(points[i])
+void packed_vector2_transform(godot::Vector2 *points, int64_t count, const godot::Transform2D &xform);
+void packed_vector3_transform(godot::Vector3 *points, int64_t count, const godot::Transform3D &xform);
+
+// values[i] = lerp(values[i], to[i], weight), over the individual floats of
+// any float packed array
+void packed_float_lerp(float *values, const float *to, int64_t count, float weight);
+
+// Zero length vectors are left as zero, like Vector3::normalize
+void packed_vector2_normalize(godot::Vector2 *points, int64_t count);
+void packed_vector3_normalize(godot::Vector3 *points, int64_t count);
+
+// r_distances[i] = points[i].distance_to(point)
+void packed_vector2_distance_to(const godot::Vector2 *points, int64_t count, const godot::Vector2 &point,
+                                float *r_distances);
+void packed_vector3_distance_to(const godot::Vector3 *points, int64_t count, const godot::Vector3 &point,
+                                float *r_distances);
+
+// Writes the indices of the points inside `aabb` (as AABB::has_point) to
+// `r_indices`, which must have room for `count` entries. Returns how many
+// were written.
+int64_t packed_vector3_cull_aabb(const godot::Vector3 *points, int64_t count, const godot::AABB &aabb,
+                                 int32_t *r_indices);
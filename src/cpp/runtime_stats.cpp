@@ -0,0 +1,129 @@
+#include "runtime_stats.h"
+
+#include <string>
+
+#include <dart_api.h>
+#include <dart_tools_api.h>
+#include <godot_cpp/classes/performance.hpp>
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/callable.hpp>
+
+#include "crossing_trace.h"
+
+// Microseconds between timeline samples
+#define TIMELINE_SAMPLE_INTERVAL 250000
+
+std::atomic<int64_t> RuntimeStats::s_counters[static_cast<int32_t>(RuntimeCounter::Count)] = {};
+int64_t RuntimeStats::s_last_timeline_sample = 0;
+
+const char *RuntimeStats::get_name(RuntimeCounter counter) {
+  switch (counter) {
+  case RuntimeCounter::InstanceBindings:
+    return "Instance Bindings";
+  case RuntimeCounter::ScriptInstances:
+    return "Script Instances";
+  case RuntimeCounter::PersistentHandles:
+    return "Persistent Handles";
+  case RuntimeCounter::WeakPersistentHandles:
+    return "Weak Persistent Handles";
+  case RuntimeCounter::PendingRefChanges:
+    return "Pending Ref Changes";
+  case RuntimeCounter::PendingDartMessages:
+    return "Pending Dart Messages";
+  case RuntimeCounter::PendingDestroys:
+    return "Pending Destroys";
+  case RuntimeCounter::WorkerJobs:
+    return "Worker Jobs";
+  case RuntimeCounter::PendingSignals:
+    return "Pending Signals";
+  default:
+    return "Unknown";
+  }
+}
+
+#define CROSSING_COUNT_CATEGORY "GodotDart Crossings/"
+#define CROSSING_TIME_CATEGORY "GodotDart Crossing Time (ms)/"
+
+static godot::StringName monitor_id(int32_t index) {
+  return godot::StringName(godot::String("GodotDart/") + RuntimeStats::get_name(static_cast<RuntimeCounter>(index)));
+}
+
+static godot::StringName crossing_monitor_id(const char *category, int32_t kind) {
+  return godot::StringName(godot::String(category) + CrossingTrace::get_kind_name(static_cast<CrossingKind>(kind)));
+}
+
+static void add_monitor(godot::Performance *performance, const godot::StringName &id, godot::Object *target,
+                        const godot::StringName &getter, int32_t index) {
+  if (performance->has_custom_monitor(id)) {
+    return;
+  }
+  godot::Array args;
+  args.push_back(index);
+  performance->add_custom_monitor(id, godot::Callable(target, getter), args);
+}
+
+static void remove_monitor(godot::Performance *performance, const godot::StringName &id) {
+  if (performance->has_custom_monitor(id)) {
+    performance->remove_custom_monitor(id);
+  }
+}
+
+void RuntimeStats::register_monitors(godot::Object *target, const godot::StringName &getter) {
+  godot::Performance *performance = godot::Performance::get_singleton();
+  if (performance == nullptr) {
+    return;
+  }
+
+  for (int32_t i = 0; i < static_cast<int32_t>(RuntimeCounter::Count); ++i) {
+    add_monitor(performance, monitor_id(i), target, getter, i);
+  }
+}
+
+void RuntimeStats::register_crossing_monitors(godot::Object *target, const godot::StringName &count_getter,
+                                              const godot::StringName &time_getter) {
+  godot::Performance *performance = godot::Performance::get_singleton();
+  if (performance == nullptr) {
+    return;
+  }
+
+  for (int32_t i = 0; i < static_cast<int32_t>(CrossingKind::Count); ++i) {
+    add_monitor(performance, crossing_monitor_id(CROSSING_COUNT_CATEGORY, i), target, count_getter, i);
+    add_monitor(performance, crossing_monitor_id(CROSSING_TIME_CATEGORY, i), target, time_getter, i);
+  }
+}
+
+void RuntimeStats::unregister_monitors() {
+  godot::Performance *performance = godot::Performance::get_singleton();
+  if (performance == nullptr) {
+    return;
+  }
+
+  for (int32_t i = 0; i < static_cast<int32_t>(RuntimeCounter::Count); ++i) {
+    remove_monitor(performance, monitor_id(i));
+  }
+  for (int32_t i = 0; i < static_cast<int32_t>(CrossingKind::Count); ++i) {
+    remove_monitor(performance, crossing_monitor_id(CROSSING_COUNT_CATEGORY, i));
+    remove_monitor(performance, crossing_monitor_id(CROSSING_TIME_CATEGORY, i));
+  }
+}
+
+void RuntimeStats::sample_to_timeline() {
+  int64_t now = Dart_TimelineGetMicros();
+  if (now - s_last_timeline_sample < TIMELINE_SAMPLE_INTERVAL) {
+    return;
+  }
+  s_last_timeline_sample = now;
+
+  const int32_t count = static_cast<int32_t>(RuntimeCounter::Count);
+  std::string values[count];
+  const char *argument_names[count];
+  const char *argument_values[count];
+  for (int32_t i = 0; i < count; ++i) {
+    values[i] = std::to_string(s_counters[i].load(std::memory_order_relaxed));
+    argument_names[i] = get_name(static_cast<RuntimeCounter>(i));
+    argument_values[i] = values[i].c_str();
+  }
+
+  Dart_RecordTimelineEvent("GodotDart Runtime", now, 0, 0, nullptr, Dart_Timeline_Event_Counter, count,
+                           argument_names, argument_values);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <godot_cpp/classes/object.hpp>
+
+// Live counts of objects and handles owned by the runtime. These are exposed
+// as custom Performance monitors under "GodotDart/" and periodically sampled
+// into the Dart timeline so leaks and handle growth can be observed while the
+// game is running.
+enum class RuntimeCounter : int32_t {
+  InstanceBindings,
+  ScriptInstances,
+  PersistentHandles,
+  WeakPersistentHandles,
+  PendingRefChanges,
+  PendingDartMessages,
+  PendingDestroys,
+  WorkerJobs,
+  PendingSignals,
+
+  Count,
+};
+
+class RuntimeStats {
+public:
+  static void increment(RuntimeCounter counter) {
+    s_counters[static_cast<int32_t>(counter)].fetch_add(1, std::memory_order_relaxed);
+  }
+  static void decrement(RuntimeCounter counter) {
+    s_counters[static_cast<int32_t>(counter)].fetch_sub(1, std::memory_order_relaxed);
+  }
+  static void set(RuntimeCounter counter, int64_t value) {
+    s_counters[static_cast<int32_t>(counter)].store(value, std::memory_order_relaxed);
+  }
+  static int64_t get(RuntimeCounter counter) {
+    return s_counters[static_cast<int32_t>(counter)].load(std::memory_order_relaxed);
+  }
+  static const char *get_name(RuntimeCounter counter);
+
+  // `target` must have a bound method `getter` taking the counter index and
+  // returning its value. Must be called from the main thread.
+  static void register_monitors(godot::Object *target, const godot::StringName &getter);
+  // Per-frame crossing counts and times, by CrossingKind, under
+  // "GodotDart Crossings/" and "GodotDart Crossing Time (ms)/". The getters
+  // take the kind index, like `getter` above.
+  static void register_crossing_monitors(godot::Object *target, const godot::StringName &count_getter,
+                                         const godot::StringName &time_getter);
+  static void unregister_monitors();
+
+  // Record the counters as a timeline counter event, at most a few times a
+  // second. Must be called from the Dart thread.
+  static void sample_to_timeline();
+
+private:
+  static std::atomic<int64_t> s_counters[static_cast<int32_t>(RuntimeCounter::Count)];
+  static int64_t s_last_timeline_sample;
+};
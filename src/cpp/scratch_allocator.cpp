@@ -0,0 +1,55 @@
+#include "scratch_allocator.h"
+
+#include <cstdlib>
+#include <cstring>
+
+ScratchAllocator *ScratchAllocator::current() {
+  // Thread locals can be destroyed after Godot's allocator, so chunks come
+  // from malloc rather than gde_mem_alloc
+  thread_local ScratchAllocator allocator;
+  return &allocator;
+}
+
+ScratchAllocator::~ScratchAllocator() {
+  for (const auto &chunk : _chunks) {
+    std::free(chunk.data);
+  }
+}
+
+void *ScratchAllocator::alloc(size_t size, size_t alignment) {
+  if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+    return nullptr;
+  }
+
+  if (_chunk_index < _chunks.size()) {
+    Chunk &chunk = _chunks[_chunk_index];
+    size_t aligned_offset = (_offset + alignment - 1) & ~(alignment - 1);
+    if (aligned_offset + size <= chunk.capacity) {
+      _offset = aligned_offset + size;
+      std::memset(chunk.data + aligned_offset, 0, size);
+      return chunk.data + aligned_offset;
+    }
+  }
+
+  // Doesn't fit, move on to the next chunk. malloc'd chunks are aligned for
+  // any fundamental type, so starting at offset 0 covers the alignment
+  size_t next_index = _chunks.empty() ? 0 : _chunk_index + 1;
+  if (next_index >= _chunks.size() || _chunks[next_index].capacity < size) {
+    size_t capacity = size > kChunkSize ? size : kChunkSize;
+    uint8_t *data = reinterpret_cast<uint8_t *>(std::malloc(capacity));
+    if (data == nullptr) {
+      return nullptr;
+    }
+    _chunks.insert(_chunks.begin() + next_index, Chunk{data, capacity});
+  }
+
+  _chunk_index = next_index;
+  _offset = size;
+  std::memset(_chunks[_chunk_index].data, 0, size);
+  return _chunks[_chunk_index].data;
+}
+
+void ScratchAllocator::reset(uint64_t mark) {
+  _chunk_index = static_cast<size_t>(mark >> 32);
+  _offset = static_cast<size_t>(mark & 0xFFFFFFFF);
+}
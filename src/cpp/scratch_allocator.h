@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A thread local bump allocator for short lived scratch memory, such as the
+// argument slots Dart fills in before a ptrcall. Callers take a mark, allocate
+// as needed, and reset back to the mark when they're done, so nested uses
+// (Dart -> Godot -> Dart) unwind like a stack.
+//
+// Memory is kept in chunks that are reused for the lifetime of the thread, so
+// once warm, allocating is a pointer bump with no calls into any allocator.
+// Allocations are zeroed, like the calloc they replace: Godot assigns into
+// ptrcall return slots, which would release whatever garbage was there.
+class ScratchAllocator {
+public:
+  static const size_t kChunkSize = 64 * 1024;
+
+  static ScratchAllocator *current();
+
+  ~ScratchAllocator();
+
+  uint64_t mark() const {
+    return (static_cast<uint64_t>(_chunk_index) << 32) | static_cast<uint64_t>(_offset);
+  }
+  void *alloc(size_t size, size_t alignment);
+  void reset(uint64_t mark);
+
+private:
+  ScratchAllocator() = default;
+
+  struct Chunk {
+    uint8_t *data;
+    size_t capacity;
+  };
+
+  std::vector<Chunk> _chunks;
+  size_t _chunk_index = 0;
+  size_t _offset = 0;
+};
@@ -1,5 +1,6 @@
 #include "dart_resource_format.h"
 
+#include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/file_access.hpp>
 #include <godot_cpp/classes/resource_loader.hpp>
 
@@ -10,6 +11,16 @@ using namespace godot;
 
 // ResourceFormatLoader
 
+static void load_source(const Ref<DartScript> &script, const godot::String &path) {
+  // Exported games run the compiled program, so only read the source if
+  // something asks for it
+  if (Engine::get_singleton()->is_editor_hint()) {
+    script->load_from_disk(path);
+  } else {
+    script->load_from_disk_lazy(path);
+  }
+}
+
 DartResourceFormatLoader::DartResourceFormatLoader() {
 }
 
@@ -55,9 +66,9 @@ godot::Variant DartResourceFormatLoader::_load(const godot::String &path, const
     }
 
     language->push_cached_script(path, script);
-    script->load_from_disk(original_path);
+    load_source(script, original_path);
   } else if (cache_mode == ResourceLoader::CACHE_MODE_IGNORE) {
-    script->load_from_disk(original_path);
+    load_source(script, original_path);
   }
   script->set_path(original_path);
 
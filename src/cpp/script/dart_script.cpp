@@ -1,23 +1,37 @@
 #include "dart_script.h"
 
+#include <atomic>
+
 #include <godot_cpp/classes/editor_file_system.hpp>
 #include <godot_cpp/classes/editor_interface.hpp>
 #include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/resource_loader.hpp>
 
 #include "../dart_bindings.h"
 
 #include "../dart_helpers.h"
 #include "../godot_string_wrappers.h"
+#include "../runtime_stats.h"
 #include "script/dart_script_instance.h"
 #include "script/dart_script_language.h"
 
 using namespace godot;
 
-DartScript::DartScript() : _source_code(), _dart_type(nullptr), _type_info(nullptr) {
+DartScript::DartScript()
+    : _source_code(), _lazy_source_path(), _cache_path(), _property_dicts_generation(0),
+      _script_property_list_valid(false), _dart_type(nullptr), _type_info(nullptr) {
+}
+
+static uint64_t next_property_dicts_generation() {
+  static std::atomic<uint64_t> s_generation = 0;
+  return ++s_generation;
 }
 
 DartScript::~DartScript() {
+  if (!_cache_path.is_empty()) {
+    DartScriptLanguage::instance()->evict_cached_script(_cache_path, this);
+  }
   clear_property_cache();
 
   GodotDartBindings *bindings = GodotDartBindings::instance();
@@ -30,9 +44,11 @@ DartScript::~DartScript() {
     // Delete old persistent handles
     if (_dart_type != nullptr) {
       Dart_DeletePersistentHandle(_dart_type);
+      RuntimeStats::decrement(RuntimeCounter::PersistentHandles);
     }
     if (_type_info != nullptr) {
       Dart_DeletePersistentHandle(_type_info);
+      RuntimeStats::decrement(RuntimeCounter::PersistentHandles);
       _type_info = nullptr;
     }
   });
@@ -44,6 +60,17 @@ void DartScript::_bind_methods() {
 godot::Ref<Script> DartScript::_get_base_script() const {
   const_cast<DartScript *>(this)->refresh_type(false);
 
+  return get_base_dart_script();
+}
+
+godot::Ref<DartScript> DartScript::get_base_dart_script() const {
+  if (_base_script.is_null() && !_base_script_path.is_empty()) {
+    _base_script = DartScriptLanguage::instance()->get_cached_script(_base_script_path);
+    if (_base_script.is_null()) {
+      _base_script = godot::ResourceLoader::get_singleton()->load(_base_script_path);
+    }
+  }
+
   return _base_script;
 }
 
@@ -53,14 +80,18 @@ godot::ScriptLanguage *DartScript::_get_language() const {
 
 void DartScript::_set_source_code(const godot::String &code) {
   _source_code = code;
+  _lazy_source_path = godot::String();
 }
 
 godot::String DartScript::_get_source_code() const {
+  if (!_lazy_source_path.is_empty()) {
+    const_cast<DartScript *>(this)->load_from_disk(_lazy_source_path);
+  }
   return _source_code;
 }
 
 bool DartScript::_has_source_code() const {
-  return !_source_code.is_empty();
+  return !_lazy_source_path.is_empty() || !_source_code.is_empty();
 }
 
 bool DartScript::_can_instantiate() const {
@@ -154,88 +185,45 @@ bool DartScript::_has_script_signal(const godot::StringName &signal) const {
 godot::TypedArray<godot::Dictionary> DartScript::_get_script_signal_list() const {
   WITH_SCRIPT_INFO(godot::TypedArray<godot::Dictionary>());
 
-  godot::TypedArray<godot::Dictionary> ret_val;
-
-  bindings->execute_on_dart_thread([&] {
-    DartBlockScope scope;
-
-    Dart_Handle type_info = Dart_HandleFromPersistent(_type_info);
-
-    Dart_Handle dart_prop_name = Dart_NewStringFromCString("signals");
-    DART_CHECK(dart_signal_list, Dart_GetField(type_info, dart_prop_name), "Error getting field signals");
-
-    intptr_t signal_size = 0;
-    Dart_ListLength(dart_signal_list, &signal_size);
-    for (intptr_t i = 0; i < signal_size; ++i) {
-      Dart_Handle signal_info = Dart_ListGetAt(dart_signal_list, i);
-
-      Dart_Handle d_as_dict = Dart_NewStringFromCString("asDict");
-      DART_CHECK(dart_godot_dict, Dart_Invoke(signal_info, d_as_dict, 0, nullptr), "Error calling asDict");
-
-      void *dict_pointer = get_object_address(dart_godot_dict);
-      godot::Dictionary signal_dict(*((godot::Dictionary *)dict_pointer));
-      ret_val.append(signal_dict);
-    }
-  });
-
-  return ret_val;
+  return _signal_dicts;
 }
 
 godot::TypedArray<godot::Dictionary> DartScript::_get_script_method_list() const {
   WITH_SCRIPT_INFO(godot::TypedArray<godot::Dictionary>());
 
-  godot::TypedArray<godot::Dictionary> ret_val;
-
-  bindings->execute_on_dart_thread([&] {
-    DartBlockScope scope;
-
-    Dart_Handle script_info = Dart_HandleFromPersistent(_type_info);
-
-    Dart_Handle dart_prop_name = Dart_NewStringFromCString("methods");
-    DART_CHECK(dart_method_list, Dart_GetField(script_info, dart_prop_name), "Error getting field methods");
-
-    intptr_t method_count = 0;
-    Dart_ListLength(dart_method_list, &method_count);
-    for (intptr_t i = 0; i < method_count; ++i) {
-      Dart_Handle method_info = Dart_ListGetAt(dart_method_list, i);
-
-      Dart_Handle d_as_dict = Dart_NewStringFromCString("asDict");
-      DART_CHECK(dart_godot_dict, Dart_Invoke(method_info, d_as_dict, 0, nullptr), "Error calling asDict");
-
-      void *dict_pointer = get_object_address(dart_godot_dict);
-      godot::Dictionary method_dict(*((godot::Dictionary *)dict_pointer));
-      ret_val.append(method_dict);
-    }
-  });
-
-  return ret_val;
+  return _method_dicts;
 }
 
 godot::TypedArray<godot::Dictionary> DartScript::_get_script_property_list() const {
   WITH_SCRIPT_INFO(godot::TypedArray<godot::Dictionary>());
 
-  godot::TypedArray<godot::Dictionary> ret_val;
-
-  const DartScript *top = this;
-  while (top != nullptr) {
-    const auto &properties_cache = top->get_properties();
-    for (const auto &prop_info : properties_cache) {
-      godot::Dictionary info_dict;
-      info_dict[godot::Variant(godot::String("type"))] = Variant(prop_info.type);
-      info_dict[godot::Variant(godot::String("name"))] =
-          Variant(*reinterpret_cast<godot::StringName *>(prop_info.name));
-      info_dict[godot::Variant(godot::String("class_name"))] =
-          Variant(*reinterpret_cast<godot::StringName *>(prop_info.class_name));
-      info_dict[godot::Variant(godot::String("hint"))] = Variant(prop_info.hint);
-      info_dict[godot::Variant(godot::String("hint_string"))] =
-          Variant(*reinterpret_cast<godot::String *>(prop_info.hint_string));
-      info_dict[godot::Variant(godot::String("usage"))] = Variant(prop_info.usage);
-      ret_val.push_back(info_dict);
+  bool valid = _script_property_list_valid;
+  if (valid) {
+    size_t index = 0;
+    const DartScript *top = this;
+    while (top != nullptr && valid) {
+      valid = index < _script_property_list_generations.size() &&
+              _script_property_list_generations[index] == top->_property_dicts_generation;
+      ++index;
+      top = top->get_base_dart_script().ptr();
     }
-    top = top->_base_script.ptr();
+    valid = valid && index == _script_property_list_generations.size();
   }
 
-  return ret_val;
+  if (!valid) {
+    _script_property_list.clear();
+    _script_property_list_generations.clear();
+
+    const DartScript *top = this;
+    while (top != nullptr) {
+      _script_property_list.append_array(top->_property_dicts);
+      _script_property_list_generations.push_back(top->_property_dicts_generation);
+      top = top->get_base_dart_script().ptr();
+    }
+    _script_property_list_valid = true;
+  }
+
+  return _script_property_list;
 }
 
 godot::Error DartScript::_reload(bool keep_state) {
@@ -258,23 +246,8 @@ godot::StringName DartScript::_get_instance_base_type() const {
     return godot::StringName();
   }
   const_cast<DartScript *>(this)->refresh_type(false);
-  if (_dart_type == nullptr) {
-    return godot::StringName();
-  }
-
-  godot::StringName native_base_type;
-  bindings->execute_on_dart_thread([&] {
-    DartBlockScope scope;
 
-    Dart_Handle dart_type = Dart_HandleFromPersistent(_dart_type);
-    DART_CHECK(type_info, Dart_GetField(dart_type, Dart_NewStringFromCString("sTypeInfo")), "Failed getting type info");
-    DART_CHECK(dart_native_type_name, Dart_GetField(type_info, Dart_NewStringFromCString("nativeTypeName")),
-               "Failed to get nativeTypeName");
-
-    native_base_type = *(godot::StringName *)get_object_address(dart_native_type_name);
-  });
-
-  return native_base_type;
+  return _native_type_name;
 }
 
 godot::TypedArray<godot::Dictionary> DartScript::_get_documentation() const {
@@ -291,6 +264,7 @@ godot::Variant DartScript::_get_property_default_value(const godot::StringName &
 }
 
 void DartScript::_update_exports() {
+  _script_property_list_valid = false;
   refresh_type(true);
 
   for (const auto &script_instance : _placeholders) {
@@ -301,28 +275,11 @@ void DartScript::_update_exports() {
 godot::StringName DartScript::_get_global_name() const {
   WITH_SCRIPT_INFO(godot::StringName());
 
-  godot::StringName ret;
-
-  bindings->execute_on_dart_thread([&] {
-    DartBlockScope scope;
-
-    Dart_Handle dart_type = Dart_HandleFromPersistent(_dart_type);
-    DART_CHECK(type_info, Dart_GetField(dart_type, Dart_NewStringFromCString("sTypeInfo")), "Failed getting type info");
-    DART_CHECK(value, Dart_GetField(type_info, Dart_NewStringFromCString("isGlobalClass")),
-               "Failed to get isGlobalClass");
-    bool is_global = false;
-    Dart_BooleanValue(value, &is_global);
-    if (is_global) {
-      DART_CHECK(class_name, Dart_GetField(type_info, Dart_NewStringFromCString("className")),
-                 "Failed getting class name from type info");
-      ret = *(godot::StringName *)get_object_address(class_name);
-    }
-  });
-
-  return ret;
+  return _global_name;
 }
 
 void DartScript::load_from_disk(const godot::String &path) {
+  _lazy_source_path = godot::String();
   Ref<FileAccess> file = FileAccess::open(path, FileAccess::READ);
   if (!file.is_null()) {
     String text = file->get_as_text();
@@ -331,8 +288,20 @@ void DartScript::load_from_disk(const godot::String &path) {
   }
 }
 
-void DartScript::did_hot_reload() {
-  _update_exports();
+void DartScript::load_from_disk_lazy(const godot::String &path) {
+  _source_code = godot::String();
+  _lazy_source_path = path;
+}
+
+void DartScript::did_hot_reload(bool type_refreshed) {
+  if (type_refreshed) {
+    for (const auto &script_instance : _placeholders) {
+      script_instance->notify_property_list_changed();
+    }
+  } else {
+    _update_exports();
+  }
+
   auto editor_interface = godot::EditorInterface::get_singleton();
   if (editor_interface) {
     String path = get_path();
@@ -440,6 +409,33 @@ void DartScript::clear_property_cache() {
     gde_free_property_info_fields(&prop);
   }
   _properties_cache.clear();
+  _property_dicts.clear();
+  _property_dicts_generation = next_property_dicts_generation();
+  _script_property_list.clear();
+  _script_property_list_valid = false;
+}
+
+void DartScript::build_property_dicts() {
+  // Keys are interned once and shared by every script
+  static const godot::StringName type_key("type", true);
+  static const godot::StringName name_key("name", true);
+  static const godot::StringName class_name_key("class_name", true);
+  static const godot::StringName hint_key("hint", true);
+  static const godot::StringName hint_string_key("hint_string", true);
+  static const godot::StringName usage_key("usage", true);
+
+  _property_dicts.clear();
+  for (const auto &prop_info : _properties_cache) {
+    godot::Dictionary info_dict;
+    info_dict[type_key] = Variant(prop_info.type);
+    info_dict[name_key] = Variant(*reinterpret_cast<godot::StringName *>(prop_info.name));
+    info_dict[class_name_key] = Variant(*reinterpret_cast<godot::StringName *>(prop_info.class_name));
+    info_dict[hint_key] = Variant(prop_info.hint);
+    info_dict[hint_string_key] = Variant(*reinterpret_cast<godot::String *>(prop_info.hint_string));
+    info_dict[usage_key] = Variant(prop_info.usage);
+    _property_dicts.push_back(info_dict);
+  }
+  _property_dicts_generation = next_property_dicts_generation();
 }
 
 void DartScript::refresh_type(bool force) {
@@ -452,97 +448,128 @@ void DartScript::refresh_type(bool force) {
     return;
   }
 
-  _base_script.unref();
-
   bindings->execute_on_dart_thread([&] {
     DartBlockScope scope;
 
-    // Delete old persistent handles
-    if (_dart_type != nullptr) {
-      Dart_DeletePersistentHandle(_dart_type);
-      _dart_type = nullptr;
-    }
-    if (_type_info != nullptr) {
-      Dart_DeletePersistentHandle(_type_info);
-      _type_info = nullptr;
-    }
-
     DartScriptLanguage *language = DartScriptLanguage::instance();
 
-    String path = get_path();
-
-    Dart_Handle dart_type = language->get_type_for_script(path);
+    Dart_Handle dart_type = language->get_type_for_script(get_path());
+    Dart_Handle type_info = Dart_Null();
+    godot::String base_script_path;
     if (!Dart_IsNull(dart_type)) {
-      _dart_type = Dart_NewPersistentHandle(dart_type);
-      DART_CHECK(type_info, Dart_GetField(dart_type, Dart_NewStringFromCString("sTypeInfo")),
+      DART_CHECK(dart_type_info, Dart_GetField(dart_type, Dart_NewStringFromCString("sTypeInfo")),
                  "Failed getting type info");
-      if (!Dart_IsNull(type_info)) {
-        _type_info = Dart_NewPersistentHandle(type_info);
+      type_info = dart_type_info;
 
-        // Find the base type
+      // Find the base type
+      if (!Dart_IsNull(type_info)) {
         DART_CHECK(base_type_info, Dart_GetField(type_info, Dart_NewStringFromCString("parentTypeInfo")),
                    "Failed to get parentTypeInfo for type");
         if (!Dart_IsNull(base_type_info)) {
           DART_CHECK(base_type, Dart_GetField(base_type_info, Dart_NewStringFromCString("type")),
                      "Failed to get type from parentTypeInfo");
           if (!Dart_IsNull(base_type)) {
-            _base_script = language->find_script_for_type(base_type);
+            base_script_path = language->get_script_for_type(base_type);
           }
         }
+      }
+    }
 
-        // Update Properties
-        clear_property_cache();
-
-        // TODO: Get properties from our base class?
-        DART_CHECK(properties_list, Dart_GetField(_type_info, Dart_NewStringFromCString("properties")),
-                   "Failed to get properties info");
-        intptr_t prop_count = 0;
-        Dart_ListLength(properties_list, &prop_count);
-
-        // Always add a secret hidden property that tells Godot the name of our class
-        {
-          DART_CHECK(class_name, Dart_GetField(type_info, Dart_NewStringFromCString("className")),
-                     "Failed to get class name.");
-          GDExtensionPropertyInfo property_info = {
-              GDEXTENSION_VARIANT_TYPE_NIL,
-              new godot::StringName(*reinterpret_cast<godot::StringName *>(get_object_address(class_name))),
-              new godot::String(),
-              PROPERTY_HINT_NONE,
-              new godot::String(path),
-              PROPERTY_USAGE_CATEGORY};
-          _properties_cache.push_back(property_info);
-        }
+    set_type(dart_type, type_info, base_script_path);
+  });
+}
 
-        if (prop_count > 0) {
-          for (auto i = 0; i < prop_count; ++i) {
-            DART_CHECK(dart_property, Dart_ListGetAt(properties_list, i), "Failed to get property at index");
-            GDExtensionPropertyInfo property_info;
-            gde_property_info_from_dart(dart_property, &property_info);
-            godot::StringName *prop_name = reinterpret_cast<godot::StringName *>(property_info.name);
-            _properties_cache.push_back(property_info);
-          }
-        }
+void DartScript::set_type(Dart_Handle dart_type, Dart_Handle type_info, const godot::String &base_script_path) {
+  // Only take the base script if it's already loaded, loading it here would
+  // go through the ResourceLoader while holding the isolate
+  _base_script_path = base_script_path;
+  _base_script = base_script_path.is_empty() ? godot::Ref<DartScript>()
+                                             : DartScriptLanguage::instance()->get_cached_script(base_script_path);
+  _native_type_name = godot::StringName();
+  _global_name = godot::StringName();
+  _script_property_list_valid = false;
+
+  // Delete old persistent handles
+  if (_dart_type != nullptr) {
+    Dart_DeletePersistentHandle(_dart_type);
+    RuntimeStats::decrement(RuntimeCounter::PersistentHandles);
+    _dart_type = nullptr;
+  }
+  if (_type_info != nullptr) {
+    Dart_DeletePersistentHandle(_type_info);
+    RuntimeStats::decrement(RuntimeCounter::PersistentHandles);
+    _type_info = nullptr;
+  }
 
-        // Update RPC Methods
-        DART_CHECK(rpc_list, Dart_GetField(type_info, Dart_NewStringFromCString("rpcInfo")), "Failed to get Rpc Info");
-        intptr_t rpc_count = 0;
-        Dart_ListLength(rpc_list, &rpc_count);
-        _rpc_config.clear();
-        if (rpc_count > 0) {
-          Dart_Handle rpc_as_dict = Dart_NewStringFromCString("asDict");
-          godot::Dictionary godot_rpc_config;
-          for (auto i = 0; i < rpc_count; ++i) {
-            DART_CHECK(rpc_info, Dart_ListGetAt(rpc_list, i), "Failed to get rpc at index");
-            DART_CHECK(dart_godot_dict, Dart_Invoke(rpc_info, rpc_as_dict, 0, nullptr), "Error calling asDict");
-
-            void *dict_pointer = get_object_address(dart_godot_dict);
-            auto dict = godot::Dictionary(*((godot::Dictionary *)dict_pointer));
-            auto name = dict.get(godot::String("name"), godot::Variant());
-            godot_rpc_config[name] = dict;
-          }
-          _rpc_config = godot_rpc_config;
-        }
+  if (Dart_IsNull(dart_type)) {
+    return;
+  }
+  _dart_type = Dart_NewPersistentHandle(dart_type);
+  RuntimeStats::increment(RuntimeCounter::PersistentHandles);
+
+  if (Dart_IsNull(type_info)) {
+    return;
+  }
+  _type_info = Dart_NewPersistentHandle(type_info);
+  RuntimeStats::increment(RuntimeCounter::PersistentHandles);
+
+  String path = get_path();
+
+  // Update properties, methods, signals and RPC config. These all come
+  // from one descriptor so we don't have to call into Dart per field.
+  clear_property_cache();
+  _method_dicts.clear();
+  _signal_dicts.clear();
+  _rpc_config.clear();
+
+  gde_read_descriptor(type_info, [&](TypeDescriptorReader &reader) {
+    if (reader.read_uint32() != TYPE_DESCRIPTOR_VERSION) {
+      GD_PRINT_ERROR("GodotDart: Type descriptor version mismatch");
+      return;
+    }
+
+    godot::StringName class_name(reader.read_string());
+    _native_type_name = godot::StringName(reader.read_string());
+    bool is_global_class = reader.read_uint8() != 0;
+    _global_name = is_global_class ? class_name : godot::StringName();
+
+    // Always add a secret hidden property that tells Godot the name of our class
+    GDExtensionPropertyInfo category_info = {
+        GDEXTENSION_VARIANT_TYPE_NIL,
+        new godot::StringName(class_name),
+        new godot::StringName(),
+        PROPERTY_HINT_NONE,
+        new godot::String(path),
+        PROPERTY_USAGE_CATEGORY};
+    _properties_cache.push_back(category_info);
+
+    uint32_t prop_count = reader.read_uint32();
+    for (uint32_t i = 0; i < prop_count && reader.is_valid(); ++i) {
+      GDExtensionPropertyInfo property_info;
+      reader.read_property_info(&property_info);
+      _properties_cache.push_back(property_info);
+    }
+
+    uint32_t method_count = reader.read_uint32();
+    for (uint32_t i = 0; i < method_count && reader.is_valid(); ++i) {
+      _method_dicts.append(reader.read_method_dict());
+    }
+
+    uint32_t signal_count = reader.read_uint32();
+    for (uint32_t i = 0; i < signal_count && reader.is_valid(); ++i) {
+      _signal_dicts.append(reader.read_signal_dict());
+    }
+
+    uint32_t rpc_count = reader.read_uint32();
+    if (rpc_count > 0) {
+      static const godot::StringName name_key("name", true);
+      godot::Dictionary godot_rpc_config;
+      for (uint32_t i = 0; i < rpc_count && reader.is_valid(); ++i) {
+        godot::Dictionary dict = reader.read_rpc_dict();
+        godot_rpc_config[dict[name_key]] = dict;
       }
+      _rpc_config = godot_rpc_config;
     }
   });
+  build_property_dicts();
 }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <unordered_set>
+#include <vector>
 
 #include <dart_api.h>
 
@@ -47,7 +49,23 @@ public:
   }
 
   void load_from_disk(const godot::String &path);
-  void did_hot_reload();
+  // Defer reading the source until something asks for it. Used outside the
+  // editor, where the code comes from the compiled program and the source
+  // text is rarely needed.
+  void load_from_disk_lazy(const godot::String &path);
+  // Path this script is cached under in DartScriptLanguage, so it can be
+  // evicted when it's freed. Empty if it isn't cached.
+  void set_cache_path(const godot::String &path) {
+    _cache_path = path;
+  }
+  // `type_refreshed` is true if the language already resolved this script's
+  // type with set_type, so only the editor needs to be notified.
+  void did_hot_reload(bool type_refreshed);
+
+  // Set the Dart type backing this script. Must be called from the Dart
+  // thread inside a Dart scope. Either handle can be Dart_Null, and
+  // `base_script_path` is empty if the type has no base script.
+  void set_type(Dart_Handle dart_type, Dart_Handle type_info, const godot::String &base_script_path);
 
   void *_instance_create(Object *for_object) const override;
   void *_placeholder_instance_create(Object *for_object) const override;
@@ -59,9 +77,9 @@ public:
   // Create the Dart object represented by this script
   Dart_Handle create_dart_object(Object *for_object);
   Dart_Handle get_dart_type_info();
-  godot::Ref<DartScript> get_base_dart_script() {
-    return _base_script;
-  }
+  // Loads the base script on first use if it wasn't loaded when the type
+  // was set
+  godot::Ref<DartScript> get_base_dart_script() const;
 
   // ScriptInstances in extensions are never of the type that calls
   // _placeholder_erased, so we handle this manually on instance free
@@ -73,14 +91,34 @@ protected:
 private:
   void refresh_type(bool force);
   void clear_property_cache();
+  void build_property_dicts();
   void *create_script_instance_internal(Object *for_object, bool is_placeholder) const;
 
   godot::String _source_code;
+  // Set by load_from_disk_lazy until the source is actually read
+  godot::String _lazy_source_path;
+  godot::String _cache_path;
   std::vector<GDExtensionPropertyInfo> _properties_cache;
+  // Dictionary versions of _properties_cache, built once in refresh_type
+  godot::TypedArray<godot::Dictionary> _property_dicts;
+  // Changes whenever _property_dicts does, unique across all scripts
+  uint64_t _property_dicts_generation;
+  // Full property list (including base scripts), built on first request and
+  // invalidated by _update_exports. It's also rebuilt if the generation of
+  // any script in the chain has changed, as base scripts refresh on their own.
+  mutable godot::TypedArray<godot::Dictionary> _script_property_list;
+  mutable std::vector<uint64_t> _script_property_list_generations;
+  mutable bool _script_property_list_valid;
   godot::Variant _rpc_config;
+  // Read from the type descriptor in refresh_type
+  godot::TypedArray<godot::Dictionary> _method_dicts;
+  godot::TypedArray<godot::Dictionary> _signal_dicts;
+  godot::StringName _native_type_name;
+  godot::StringName _global_name;
 
   mutable std::unordered_set<DartScriptInstance *> _placeholders;
   mutable godot::Ref<DartScript> _base_script;
+  godot::String _base_script_path;
   mutable Dart_PersistentHandle _dart_type;
   mutable Dart_PersistentHandle _type_info;
 };
\ No newline at end of file
@@ -6,10 +6,12 @@
 
 #include <godot_cpp/classes/object.hpp>
 
+#include "crossing_trace.h"
 #include "dart_bindings.h"
 #include "dart_helpers.h"
 #include "gde_wrapper.h"
 #include "ref_counted_wrapper.h"
+#include "runtime_stats.h"
 
 #include "script/dart_script_language.h"
 
@@ -20,20 +22,23 @@ DartScriptInstance::DartScriptInstance(godot::Ref<DartScript> script, godot::Obj
     : _is_placeholder(is_placeholder), _is_refcounted(is_refcounted), _godot_object(owner) {
 
   s_instanceMap[(intptr_t)this] = this;
+  RuntimeStats::increment(RuntimeCounter::ScriptInstances);
   _dart_script = script;
   create_dart_object();
 }
 
 DartScriptInstance::~DartScriptInstance() {
   s_instanceMap.erase((intptr_t)this);
+  RuntimeStats::decrement(RuntimeCounter::ScriptInstances);
 }
 
 Dart_Handle DartScriptInstance::get_dart_object() {
-  if (_binding.has_value()) {
+  if (_binding.has_value() && _binding->is_initialized()) {
     return _binding->get_dart_object();
   }
 
-  // If we don't have one already, lazily create it and return it.
+  // If we don't have one already (or it was collected while Godot kept the
+  // object alive), lazily create it and return it.
   return create_dart_object();
 }
 
@@ -73,6 +78,7 @@ bool DartScriptInstance::set(const godot::StringName &p_name, GDExtensionConstVa
   bool set_value = false;
   gde->execute_on_dart_thread([&] {
     DartBlockScope scope;
+    CrossingTraceScope trace(CrossingKind::ScriptSet, p_name);
 
     DART_CHECK(object, get_dart_object(), "Failed to get instance from persistent handle");
     if (Dart_IsNull(object)) {
@@ -128,6 +134,7 @@ bool DartScriptInstance::get(const godot::StringName &p_name, GDExtensionVariant
   bool got_value = false;
   gde->execute_on_dart_thread([&] {
     DartBlockScope scope;
+    CrossingTraceScope trace(CrossingKind::ScriptGet, p_name);
     Dart_Handle field_name = to_dart_string(p_name);
 
     DART_CHECK(object, get_dart_object(), "Failed to get instance from persistent handle");
@@ -323,6 +330,7 @@ GDExtensionBool DartScriptInstance::has_method(const godot::StringName &p_name)
   bool hasMethod = false;
   gde->execute_on_dart_thread([&] {
     DartBlockScope scope;
+    CrossingTraceScope trace(CrossingKind::ScriptCall, *p_method);
 
     DART_CHECK(object, get_dart_object(), "Failed to get instance from persistent handle");
     if (Dart_IsNull(object)) {
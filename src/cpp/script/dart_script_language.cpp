@@ -2,12 +2,17 @@
 
 #include <godot_cpp/classes/editor_file_system.hpp>
 #include <godot_cpp/classes/editor_interface.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
 #include <godot_cpp/classes/resource_loader.hpp>
+#include <godot_cpp/core/object.hpp>
 
 #include "../dart_bindings.h"
+#include "../dart_memory_notifier.h"
+#include "../dart_thread_pool_tasks.h"
 #include "../dart_helpers.h"
 #include "../editor/dart_templates.h"
 #include "../godot_string_wrappers.h"
+#include "../runtime_stats.h"
 
 #include "dart_script.h"
 
@@ -23,10 +28,23 @@ DartScriptLanguage *DartScriptLanguage::instance() {
 void DartScriptLanguage::shutdown() {
   s_instance = nullptr;
 
+  // Scripts can outlive the language, make sure they don't try to evict
+  // themselves from it
+  _prewarmed_scripts.clear();
+  {
+    auto scripts = get_cached_scripts();
+    for (const auto &itr : scripts) {
+      itr.second->set_cache_path(godot::String());
+    }
+    std::lock_guard<std::mutex> guard(_script_cache_lock);
+    _script_cache.clear();
+  }
+
   memdelete(this);
 }
 
-DartScriptLanguage::DartScriptLanguage() : _type_resolver(nullptr) {
+DartScriptLanguage::DartScriptLanguage()
+    : _script_types_valid(false), _type_resolver(nullptr), _memory_notifier_attached(false) {
 }
 
 void DartScriptLanguage::_init() {
@@ -177,9 +195,12 @@ godot::String DartScriptLanguage::_auto_indent_code(const godot::String &code, i
 /* Thread Functions */
 
 void DartScriptLanguage::_thread_enter() {
+  // Nothing to do until the thread runs Dart code, most threads never will.
+  // DartThreadPoolTasks binds a helper isolate to the thread on first use.
 }
 
 void DartScriptLanguage::_thread_exit() {
+  DartThreadPoolTasks::instance()->thread_exit();
 }
 
 /* Debugger Functions */
@@ -259,6 +280,11 @@ void DartScriptLanguage::_frame() {
   GodotDartBindings *bindings = GodotDartBindings::instance();
   if (bindings != nullptr) {
     bindings->perform_frame_maintanance();
+
+    // The SceneTree doesn't exist yet when the language is initialized
+    if (!_memory_notifier_attached) {
+      _memory_notifier_attached = DartMemoryNotifier::attach();
+    }
   }
 }
 
@@ -267,77 +293,13 @@ bool DartScriptLanguage::_handles_global_class_type(const godot::String &type) c
 }
 
 godot::Dictionary DartScriptLanguage::_get_global_class_name(const godot::String &path) const {
-  godot::Dictionary ret{};
-
-  GodotDartBindings *bindings = GodotDartBindings::instance();
-  if (bindings == nullptr) {
-    return ret;
+  std::lock_guard<std::mutex> guard(_global_classes_lock);
+  auto itr = _global_classes.find(path);
+  if (itr == _global_classes.end()) {
+    return godot::Dictionary();
   }
 
-  bindings->execute_on_dart_thread([&] {
-    DartBlockScope scope;
-
-    Dart_Handle dart_type = get_type_for_script(path);
-    if (Dart_IsNull(dart_type)) {
-      return;
-    }
-
-    // Some strings we're going to need a bunch during this call
-    Dart_Handle s_type_info_str = Dart_NewStringFromCString("sTypeInfo");
-    Dart_Handle is_global_class_str = Dart_NewStringFromCString("isGlobalClass");
-    Dart_Handle class_name_str = Dart_NewStringFromCString("className");
-
-    Dart_Handle args[] = {dart_type};
-    DART_CHECK(type_info, Dart_GetField(dart_type, s_type_info_str), "Failed getting type info");
-    DART_CHECK(value, Dart_GetField(type_info, is_global_class_str), "Failed to get global class value");
-    bool is_global = false;
-    Dart_BooleanValue(value, &is_global);
-    if (is_global) {
-
-      DART_CHECK(class_name, Dart_GetField(type_info, class_name_str), "Failed getting class name from type info");
-      godot::StringName gd_class_name = *(godot::StringName *)get_object_address(class_name);
-      ret["name"] = godot::String(gd_class_name);
-
-      DART_CHECK(native_type_name, Dart_GetField(type_info, Dart_NewStringFromCString("nativeTypeName")),
-                 "Failed getting class name from type info");
-      godot::StringName gd_native_type_name = *(godot::StringName *)get_object_address(native_type_name);
-
-      // More overly used strings
-      Dart_Handle parent_type_info_str = Dart_NewStringFromCString("parentTypeInfo");
-
-      Dart_Handle current_type_info = type_info;
-
-      bool found_base_type = false;
-
-      while (!found_base_type) {
-        DART_CHECK(parent_type_info, Dart_GetField(current_type_info, parent_type_info_str),
-                   "Failed getting parent type info");
-        if (Dart_IsNull(parent_type_info)) {
-          break;
-        }
-        DART_CHECK(value, Dart_GetField(parent_type_info, is_global_class_str),
-                   "Failed to get isGlobalClass from typeInfo!");
-        bool is_global = false;
-        Dart_BooleanValue(value, &is_global);
-
-        DART_CHECK(class_name, Dart_GetField(parent_type_info, class_name_str),
-                   "Failed getting class name from type info");
-        godot::StringName gd_class_name = *(godot::StringName *)get_object_address(class_name);
-        if (gd_class_name == gd_native_type_name || is_global) {
-          found_base_type = true;
-          ret["base_type"] = godot::String(gd_class_name);
-          break;
-        }
-        current_type_info = parent_type_info;
-      }
-
-      if (!found_base_type) {
-        ret["base_type"] = godot::String(gd_native_type_name);
-      }
-    }
-  });
-
-  return ret;
+  return itr->second;
 }
 
 void DartScriptLanguage::attach_type_resolver(Dart_Handle resolver) {
@@ -363,6 +325,14 @@ Dart_Handle DartScriptLanguage::get_type_for_script(const godot::String &path) c
   Dart_Handle ret = Dart_Null();
 
   bindings->execute_on_dart_thread([&] {
+    if (_script_types_valid) {
+      auto itr = _script_types.find(path);
+      if (itr != _script_types.end()) {
+        ret = Dart_HandleFromPersistent(itr->second.dart_type);
+      }
+      return;
+    }
+
     Dart_Handle resolver = Dart_HandleFromPersistent(_type_resolver);
     Dart_Handle dart_path = to_dart_string(path);
     Dart_Handle args[] = {dart_path};
@@ -388,6 +358,15 @@ godot::String DartScriptLanguage::get_script_for_type(Dart_Handle dart_type) con
   godot::String ret;
 
   bindings->execute_on_dart_thread([&] {
+    // Types can't be hashed from native code, but they are canonical, so an identity
+    // check against the few script types is still far cheaper than calling into Dart
+    for (const auto &itr : _script_types) {
+      if (Dart_IdentityEquals(Dart_HandleFromPersistent(itr.second.dart_type), dart_type)) {
+        ret = itr.first;
+        return;
+      }
+    }
+
     Dart_Handle resolver = Dart_HandleFromPersistent(_type_resolver);
     Dart_Handle args[] = {dart_type};
 
@@ -401,47 +380,263 @@ godot::String DartScriptLanguage::get_script_for_type(Dart_Handle dart_type) con
   return ret;
 }
 
+void DartScriptLanguage::clear_script_type_cache() {
+  for (const auto &itr : _script_types) {
+    Dart_DeletePersistentHandle(itr.second.dart_type);
+    Dart_DeletePersistentHandle(itr.second.type_info);
+    RuntimeStats::decrement(RuntimeCounter::PersistentHandles);
+    RuntimeStats::decrement(RuntimeCounter::PersistentHandles);
+  }
+  _script_types.clear();
+  _script_types_valid = false;
+
+  std::unordered_map<godot::String, godot::Dictionary, StringHasher> global_classes;
+  std::lock_guard<std::mutex> guard(_global_classes_lock);
+  _global_classes.swap(global_classes);
+}
+
+void DartScriptLanguage::rebuild_global_class_table() {
+  static const godot::StringName name_key("name", true);
+  static const godot::StringName base_type_key("base_type", true);
+  static const godot::StringName icon_path_key("icon_path", true);
+
+  Dart_Handle resolver = Dart_HandleFromPersistent(_type_resolver);
+  DART_CHECK(table, Dart_Invoke(resolver, Dart_NewStringFromCString("getGlobalClassTable"), 0, nullptr),
+             "Failed to get global class table");
+  intptr_t table_length = 0;
+  DART_CHECK(length_result, Dart_ListLength(table, &table_length), "Failed to get global class table length");
+
+  // Entries are groups of (path, name, base type, icon path)
+  const intptr_t entry_size = 4;
+  std::vector<Dart_Handle> entries(table_length);
+  DART_CHECK(range_result, Dart_ListGetRange(table, 0, table_length, entries.data()),
+             "Failed to read global class table");
+
+  std::unordered_map<godot::String, godot::Dictionary, StringHasher> global_classes;
+  for (intptr_t i = 0; i + entry_size <= table_length; i += entry_size) {
+    godot::Dictionary global_class;
+    global_class[name_key] = create_godot_string(entries[i + 1]);
+    global_class[base_type_key] = create_godot_string(entries[i + 2]);
+    global_class[icon_path_key] = create_godot_string(entries[i + 3]);
+    global_classes.insert({create_godot_string(entries[i]), global_class});
+  }
+
+  std::lock_guard<std::mutex> guard(_global_classes_lock);
+  _global_classes.swap(global_classes);
+}
+
+// Must be called with _script_cache_lock held. A script whose refcount has
+// already hit 0 is still in the ObjectDB until its destructor has evicted it,
+// which needs the lock, and Ref won't take a reference to it.
+static godot::Ref<DartScript> resolve_cached_script(godot::ObjectID id) {
+  return godot::Ref<DartScript>(godot::Object::cast_to<DartScript>(godot::ObjectDB::get_instance(id)));
+}
+
 godot::Ref<DartScript> DartScriptLanguage::get_cached_script(const godot::String &path) {
-  auto script_itr = _script_cache.find(path);
+  std::lock_guard<std::mutex> guard(_script_cache_lock);
+  auto script_itr = _script_cache.find(ScriptCacheKey(path));
   if (script_itr == _script_cache.end()) {
     return godot::Ref<DartScript>();
   }
-  return script_itr->second;
+  return resolve_cached_script(script_itr->second);
+}
+
+std::vector<std::pair<godot::String, godot::Ref<DartScript>>> DartScriptLanguage::get_cached_scripts() {
+  std::vector<std::pair<godot::String, godot::Ref<DartScript>>> scripts;
+  std::lock_guard<std::mutex> guard(_script_cache_lock);
+  scripts.reserve(_script_cache.size());
+  for (const auto &itr : _script_cache) {
+    godot::Ref<DartScript> script = resolve_cached_script(itr.second);
+    if (script.is_valid()) {
+      scripts.push_back({itr.first.path, script});
+    }
+  }
+  return scripts;
+}
+
+bool DartScriptLanguage::has_cached_script(const godot::String &path) {
+  std::lock_guard<std::mutex> guard(_script_cache_lock);
+  return _script_cache.find(ScriptCacheKey(path)) != _script_cache.end();
 }
 
 void DartScriptLanguage::push_cached_script(const godot::String &path, godot::Ref<DartScript> script) {
-  _script_cache.insert({path, script});
+  if (script.is_null()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(_script_cache_lock);
+  // Replacing a script at the same path leaves the old one's cache path as
+  // is. Eviction checks the ID, so it won't remove the new entry.
+  _script_cache[ScriptCacheKey(path)] = script->get_instance_id();
+  script->set_cache_path(path);
 }
 
-godot::Ref<DartScript> DartScriptLanguage::find_script_for_type(Dart_Handle dart_type) {
-  godot::String script_path = get_script_for_type(dart_type);
-  // No idea what this type is....
-  if (script_path.is_empty()) {
-    return godot::Ref<DartScript>();
+void DartScriptLanguage::evict_cached_script(const godot::String &path, DartScript *script) {
+  std::lock_guard<std::mutex> guard(_script_cache_lock);
+  auto script_itr = _script_cache.find(ScriptCacheKey(path));
+  if (script_itr != _script_cache.end() && script_itr->second == godot::ObjectID(script->get_instance_id())) {
+    _script_cache.erase(script_itr);
   }
+}
 
-  godot::Ref<DartScript> ret = get_cached_script(script_path);
-  if (ret.is_null()) {
-    ret = godot::ResourceLoader::get_singleton()->load(script_path);
+bool DartScriptLanguage::prewarm_script_types(PathSet *refresh_paths) {
+  GodotDartBindings *bindings = GodotDartBindings::instance();
+  if (bindings == nullptr || _type_resolver == nullptr) {
+    return false;
   }
 
-  return ret;
+  bool success = false;
+  bindings->execute_on_dart_thread([&] {
+    DartBlockScope scope;
+
+    Dart_Handle resolver = Dart_HandleFromPersistent(_type_resolver);
+    DART_CHECK(table, Dart_Invoke(resolver, Dart_NewStringFromCString("getScriptTypeTable"), 0, nullptr),
+               "Failed to get script type table");
+    intptr_t table_length = 0;
+    DART_CHECK(length_result, Dart_ListLength(table, &table_length), "Failed to get script type table length");
+
+    // Entries are groups of (path, type, typeInfo, base script path)
+    const intptr_t entry_size = 4;
+    std::vector<Dart_Handle> entries(table_length);
+    DART_CHECK(range_result, Dart_ListGetRange(table, 0, table_length, entries.data()),
+               "Failed to read script type table");
+
+    PathSet previous_paths;
+    if (refresh_paths != nullptr) {
+      for (const auto &itr : _script_types) {
+        previous_paths.insert(itr.first);
+      }
+    }
+
+    // Rebuild the native path <-> type cache
+    clear_script_type_cache();
+    for (intptr_t i = 0; i + entry_size <= table_length; i += entry_size) {
+      ScriptTypeEntry entry;
+      entry.dart_type = Dart_NewPersistentHandle(entries[i + 1]);
+      entry.type_info = Dart_NewPersistentHandle(entries[i + 2]);
+      RuntimeStats::increment(RuntimeCounter::PersistentHandles);
+      RuntimeStats::increment(RuntimeCounter::PersistentHandles);
+      if (!Dart_IsNull(entries[i + 3])) {
+        entry.base_script_path = create_godot_string(entries[i + 3]);
+      }
+      _script_types.insert({create_godot_string(entries[i]), entry});
+    }
+    _script_types_valid = true;
+
+    rebuild_global_class_table();
+
+    if (refresh_paths != nullptr) {
+      // New scripts need their type regardless of what changed
+      std::unordered_map<godot::String, std::vector<godot::String>, StringHasher> subclasses;
+      for (const auto &itr : _script_types) {
+        if (previous_paths.find(itr.first) == previous_paths.end()) {
+          refresh_paths->insert(itr.first);
+        }
+        if (!itr.second.base_script_path.is_empty()) {
+          subclasses[itr.second.base_script_path].push_back(itr.first);
+        }
+      }
+
+      // Subclasses include their base script's properties and methods, so
+      // they need refreshing whenever a base script does
+      std::vector<godot::String> pending(refresh_paths->begin(), refresh_paths->end());
+      while (!pending.empty()) {
+        godot::String path = pending.back();
+        pending.pop_back();
+        auto children = subclasses.find(path);
+        if (children == subclasses.end()) {
+          continue;
+        }
+        for (const auto &child : children->second) {
+          if (refresh_paths->insert(child).second) {
+            pending.push_back(child);
+          }
+        }
+      }
+    }
+
+    std::map<godot::String, godot::Ref<DartScript>> scripts;
+    for (intptr_t i = 0; i + entry_size <= table_length; i += entry_size) {
+      godot::String path = create_godot_string(entries[i]);
+      scripts[path] = get_cached_script(path);
+    }
+
+    for (intptr_t i = 0; i + entry_size <= table_length; i += entry_size) {
+      godot::String path = create_godot_string(entries[i]);
+      if (refresh_paths != nullptr && refresh_paths->find(path) == refresh_paths->end()) {
+        continue;
+      }
+      godot::Ref<DartScript> script = scripts[path];
+      if (script.is_null()) {
+        continue;
+      }
+
+      godot::String base_script_path;
+      if (!Dart_IsNull(entries[i + 3])) {
+        base_script_path = create_godot_string(entries[i + 3]);
+      }
+      script->set_type(entries[i + 1], entries[i + 2], base_script_path);
+    }
+
+    // Anything cached that the resolver doesn't know about no longer has a type
+    for (const auto &itr : get_cached_scripts()) {
+      const godot::String &path = itr.first;
+      if (scripts.find(path) != scripts.end()) {
+        continue;
+      }
+      if (refresh_paths != nullptr) {
+        if (previous_paths.find(path) == previous_paths.end()) {
+          continue;
+        }
+        refresh_paths->insert(path);
+      }
+      itr.second->set_type(Dart_Null(), Dart_Null(), godot::String());
+    }
+
+    success = true;
+  });
+
+  return success;
 }
 
-void DartScriptLanguage::did_finish_hot_reload() {
-  for (const auto itr : _script_cache) {
-    itr.second->did_hot_reload();
+void DartScriptLanguage::load_uncached_scripts() {
+  GodotDartBindings *bindings = GodotDartBindings::instance();
+  if (bindings == nullptr) {
+    return;
   }
 
-  auto editor_interface = godot::EditorInterface::get_singleton();
-  // Don't bother with the rest if there's not editor interface
-  if (!editor_interface) return;
+  // Loading a script goes back through the ResourceLoader, so only collect
+  // the paths while holding the isolate
+  std::vector<godot::String> paths;
+  bindings->execute_on_dart_thread([&] {
+    for (const auto &itr : _script_types) {
+      if (get_cached_script(itr.first).is_null()) {
+        paths.push_back(itr.first);
+      }
+    }
+  });
 
+  // Each script resolves its type from the native table on first use
+  for (const auto &path : paths) {
+    godot::Ref<DartScript> script = godot::ResourceLoader::get_singleton()->load(path);
+    if (script.is_valid()) {
+      _prewarmed_scripts.push_back(script);
+    }
+  }
+}
+
+void DartScriptLanguage::did_finish_hot_reload() {
   GodotDartBindings *bindings = GodotDartBindings::instance();
   if (bindings == nullptr) {
     return;
   }
 
+  // Scripts whose libraries changed in this reload. If the reloader couldn't
+  // tell us, everything is refreshed.
+  bool has_changed_libraries = false;
+  PathSet refresh_paths;
+
+  // Repopulate the resolver first so new and renamed scripts are known
   bindings->execute_on_dart_thread([&] {
     DartBlockScope scope;
 
@@ -449,22 +644,91 @@ void DartScriptLanguage::did_finish_hot_reload() {
     DART_CHECK(refresh_result, Dart_Invoke(root_library, Dart_NewStringFromCString("refreshScripts"), 0, nullptr),
                "Failed to refresh scripts after hot reload.");
 
-    // Update files that are global classes (and weren't part of the prveious reload)
-    Dart_Handle resolver = Dart_HandleFromPersistent(_type_resolver);
+    Dart_Handle godot_dart_library = Dart_HandleFromPersistent(bindings->_godot_dart_library);
+    DART_CHECK(changed_libraries,
+               Dart_Invoke(godot_dart_library, Dart_NewStringFromCString("_getChangedLibraries"), 0, nullptr),
+               "Failed to get libraries changed by hot reload.");
+    if (Dart_IsNull(changed_libraries)) {
+      return;
+    }
 
-    DART_CHECK(global_classes, Dart_Invoke(resolver, Dart_NewStringFromCString("getGlobalClassPaths"), 0, nullptr),
-               "Failed to invoke resolver!");
-    intptr_t list_length = 0;
-    DART_CHECK(result, Dart_ListLength(global_classes, &list_length), "Failed to get global class length");
-    for (intptr_t i = 0; i < list_length; ++i) {
-      DART_CHECK(global_class_path, Dart_ListGetAt(global_classes, i), "Failed to get global class path");
-      godot::String godot_path = create_godot_string(global_class_path);
-      if (_script_cache.find(godot_path) == _script_cache.end()) {
-        editor_interface->get_resource_filesystem()->update_file(godot_path);
+    intptr_t length = 0;
+    DART_CHECK(length_result, Dart_ListLength(changed_libraries, &length), "Failed to get changed library count");
+    std::vector<Dart_Handle> library_paths(length);
+    DART_CHECK(range_result, Dart_ListGetRange(changed_libraries, 0, length, library_paths.data()),
+               "Failed to read changed libraries");
+
+    godot::ProjectSettings *project_settings = godot::ProjectSettings::get_singleton();
+    for (const auto &library_path : library_paths) {
+      godot::String local_path = project_settings->localize_path(create_godot_string(library_path));
+      if (local_path.begins_with("res://")) {
+        refresh_paths.insert(local_path);
       }
     }
+    has_changed_libraries = true;
   });
+
+  bool type_refreshed = prewarm_script_types(has_changed_libraries ? &refresh_paths : nullptr);
+  // did_hot_reload can cause scripts to be freed, so hold on to them until
+  // we're done
+  std::vector<godot::Ref<DartScript>> reloaded_scripts;
+  for (const auto &itr : get_cached_scripts()) {
+    if (!has_changed_libraries || refresh_paths.find(itr.first) != refresh_paths.end()) {
+      reloaded_scripts.push_back(itr.second);
+    }
+  }
+  for (const auto &script : reloaded_scripts) {
+    script->did_hot_reload(type_refreshed);
+  }
+
+  auto editor_interface = godot::EditorInterface::get_singleton();
+  // Don't bother with the rest if there's not editor interface
+  if (!editor_interface) return;
+
+  std::unordered_map<godot::String, godot::Dictionary, StringHasher> global_classes;
+  {
+    std::lock_guard<std::mutex> guard(_global_classes_lock);
+    global_classes = _global_classes;
+  }
+
+  // Update files that are global classes (and weren't part of the prveious reload)
+  for (const auto &itr : global_classes) {
+    if (has_changed_libraries && refresh_paths.find(itr.first) == refresh_paths.end()) {
+      continue;
+    }
+    if (!has_cached_script(itr.first)) {
+      editor_interface->get_resource_filesystem()->update_file(itr.first);
+    }
+  }
+}
+
+int64_t DartScriptLanguage::get_runtime_counter(int32_t counter) const {
+  if (counter < 0 || counter >= static_cast<int32_t>(RuntimeCounter::Count)) {
+    return 0;
+  }
+  return RuntimeStats::get(static_cast<RuntimeCounter>(counter));
+}
+
+int64_t DartScriptLanguage::get_crossing_count(int32_t kind) const {
+  GodotDartBindings *bindings = GodotDartBindings::instance();
+  if (bindings == nullptr || kind < 0 || kind >= static_cast<int32_t>(CrossingKind::Count)) {
+    return 0;
+  }
+  return bindings->get_frame_crossing_count(static_cast<CrossingKind>(kind));
+}
+
+double DartScriptLanguage::get_crossing_time_msec(int32_t kind) const {
+  GodotDartBindings *bindings = GodotDartBindings::instance();
+  if (bindings == nullptr || kind < 0 || kind >= static_cast<int32_t>(CrossingKind::Count)) {
+    return 0.0;
+  }
+  return bindings->get_frame_crossing_usec(static_cast<CrossingKind>(kind)) / 1000.0;
 }
 
 void DartScriptLanguage::_bind_methods() {
+  godot::ClassDB::bind_method(godot::D_METHOD("get_runtime_counter", "counter"),
+                              &DartScriptLanguage::get_runtime_counter);
+  godot::ClassDB::bind_method(godot::D_METHOD("get_crossing_count", "kind"), &DartScriptLanguage::get_crossing_count);
+  godot::ClassDB::bind_method(godot::D_METHOD("get_crossing_time_msec", "kind"),
+                              &DartScriptLanguage::get_crossing_time_msec);
 }
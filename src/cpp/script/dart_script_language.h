@@ -1,10 +1,15 @@
 #pragma once
 
 #include <map>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "dart_script.h"
 #include <dart_api.h>
 #include <godot_cpp/classes/script_language_extension.hpp>
+#include <godot_cpp/core/object_id.hpp>
 
 class DartScriptLanguage : public godot::ScriptLanguageExtension {
   GDCLASS(DartScriptLanguage, godot::ScriptLanguageExtension);
@@ -113,26 +118,104 @@ public:
 
   /* Godot Dart Functions */
 
+  struct StringHasher {
+    size_t operator()(const godot::String &str) const {
+      return str.hash();
+    }
+  };
+  typedef std::unordered_set<godot::String, StringHasher> PathSet;
+
   void shutdown();
 
   void attach_type_resolver(Dart_Handle resolver);
   Dart_Handle get_type_for_script(const godot::String &path) const;
   godot::String get_script_for_type(Dart_Handle dart_type) const;
 
+  // The cache is used from ResourceLoader threads and scripts can be freed
+  // on any thread, so all of these lock it
   godot::Ref<DartScript> get_cached_script(const godot::String &path);
   void push_cached_script(const godot::String &path, godot::Ref<DartScript> script);
-  godot::Ref<DartScript> find_script_for_type(Dart_Handle dart_type);
-
+  // Called by DartScript when it's freed so the cache never holds dead scripts
+  void evict_cached_script(const godot::String &path, DartScript *script);
+
+  // Resolve the type of every script known to the type resolver in one pass,
+  // so scripts don't have to resolve themselves when first touched. Returns
+  // false if the resolver couldn't be queried.
+  //
+  // If `refresh_paths` is supplied, only those scripts, their subclasses, and
+  // scripts whose type appeared or disappeared are given their new type. On
+  // return it holds every path that was refreshed.
+  bool prewarm_script_types(PathSet *refresh_paths = nullptr);
+  // Load every script the resolver knows about that isn't loaded yet, so an
+  // exported game doesn't load them during play. Must not be called while
+  // holding the isolate.
+  void load_uncached_scripts();
+  // Must be called from the Dart thread, as it releases persistent handles
+  void clear_script_type_cache();
   void did_finish_hot_reload();
 
+  // Bound so it can back the runtime's Performance monitors
+  int64_t get_runtime_counter(int32_t counter) const;
+  // The last frame's crossings of a CrossingKind, and the time spent in them
+  int64_t get_crossing_count(int32_t kind) const;
+  double get_crossing_time_msec(int32_t kind) const;
+
   static DartScriptLanguage *instance();
 
 protected:
   static void _bind_methods();
 
 private:
+  // Called from prewarm_script_types on the Dart thread
+  void rebuild_global_class_table();
+
   static DartScriptLanguage *s_instance;
 
-  std::map<godot::String, godot::Ref<DartScript>> _script_cache;
+  struct ScriptTypeEntry {
+    Dart_PersistentHandle dart_type = nullptr;
+    Dart_PersistentHandle type_info = nullptr;
+    godot::String base_script_path;
+  };
+
+  // Paths are hashed once when a script is cached rather than on every
+  // comparison
+  struct ScriptCacheKey {
+    godot::String path;
+    uint32_t hash;
+
+    explicit ScriptCacheKey(const godot::String &p_path) : path(p_path), hash(p_path.hash()) {
+    }
+    bool operator==(const ScriptCacheKey &other) const {
+      return hash == other.hash && path == other.path;
+    }
+  };
+
+  struct ScriptCacheKeyHasher {
+    size_t operator()(const ScriptCacheKey &key) const {
+      return key.hash;
+    }
+  };
+
+  // Every live cached script, along with its path
+  std::vector<std::pair<godot::String, godot::Ref<DartScript>>> get_cached_scripts();
+  bool has_cached_script(const godot::String &path);
+
+  // Weak, scripts remove themselves when they're freed, and lookups go through
+  // the ObjectDB so a script that's being freed is never revived. Only the
+  // runtime keeps strong references, in _prewarmed_scripts, as the set of
+  // scripts in an exported game never changes.
+  std::unordered_map<ScriptCacheKey, godot::ObjectID, ScriptCacheKeyHasher> _script_cache;
+  std::mutex _script_cache_lock;
+  std::vector<godot::Ref<DartScript>> _prewarmed_scripts;
+  // Native copy of the TypeResolver's script maps, rebuilt by prewarm_script_types
+  // so path and type lookups don't need to call into Dart
+  std::unordered_map<godot::String, ScriptTypeEntry, StringHasher> _script_types;
+  bool _script_types_valid;
+  // Answers for _get_global_class_name, keyed by path. The editor asks from its
+  // filesystem scan thread, so the table is rebuilt on the side and swapped
+  // in under the lock.
+  std::unordered_map<godot::String, godot::Dictionary, StringHasher> _global_classes;
+  mutable std::mutex _global_classes_lock;
   Dart_PersistentHandle _type_resolver;
+  bool _memory_notifier_attached;
 };
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "size_class_pool.h"
+
+#include "gde_c_interface.h"
+
+// Marks a block that was too large for the pool
+#define LARGE_BLOCK_CLASS UINT64_MAX
+
+// Every block is prefixed with its size class. Using a full 8 bytes keeps the
+// block itself 8 byte aligned.
+struct BlockHeader {
+  uint64_t size_class;
+};
+
+SizeClassPool *SizeClassPool::instance() {
+  static SizeClassPool pool;
+  return &pool;
+}
+
+void *SizeClassPool::alloc(size_t size) {
+  size_t total_size = sizeof(BlockHeader) + size;
+  if (total_size > kMaxCellSize) {
+    BlockHeader *header = reinterpret_cast<BlockHeader *>(gde_mem_alloc(total_size));
+    if (header == nullptr) {
+      return nullptr;
+    }
+    header->size_class = LARGE_BLOCK_CLASS;
+    return header + 1;
+  }
+
+  size_t class_index = (total_size + kGranularity - 1) / kGranularity - 1;
+  SizeClass &size_class = _size_classes[class_index];
+
+  std::lock_guard<std::mutex> guard(size_class.lock);
+  if (size_class.free_list == nullptr) {
+    grow(size_class, (class_index + 1) * kGranularity);
+    if (size_class.free_list == nullptr) {
+      return nullptr;
+    }
+  }
+
+  FreeCell *cell = size_class.free_list;
+  size_class.free_list = cell->next;
+
+  size_class.stats.total_allocations++;
+  size_class.stats.live_cells++;
+  if (size_class.stats.live_cells > size_class.stats.peak_cells) {
+    size_class.stats.peak_cells = size_class.stats.live_cells;
+  }
+
+  BlockHeader *header = reinterpret_cast<BlockHeader *>(cell);
+  header->size_class = class_index;
+  return header + 1;
+}
+
+void SizeClassPool::free(void *ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+
+  BlockHeader *header = reinterpret_cast<BlockHeader *>(ptr) - 1;
+  if (header->size_class == LARGE_BLOCK_CLASS) {
+    gde_mem_free(header);
+    return;
+  }
+
+  SizeClass &size_class = _size_classes[header->size_class];
+  FreeCell *cell = reinterpret_cast<FreeCell *>(header);
+
+  std::lock_guard<std::mutex> guard(size_class.lock);
+  cell->next = size_class.free_list;
+  size_class.free_list = cell;
+  size_class.stats.live_cells--;
+}
+
+bool SizeClassPool::get_stats(int32_t size_class, GDEPoolStats *stats) {
+  if (size_class < 0 || size_class >= static_cast<int32_t>(kSizeClassCount) || stats == nullptr) {
+    return false;
+  }
+
+  SizeClass &entry = _size_classes[size_class];
+  std::lock_guard<std::mutex> guard(entry.lock);
+  *stats = entry.stats;
+  stats->cell_size = (size_class + 1) * kGranularity;
+  return true;
+}
+
+void SizeClassPool::grow(SizeClass &size_class, size_t cell_size) {
+  uint8_t *slab = reinterpret_cast<uint8_t *>(gde_mem_alloc(kSlabSize));
+  if (slab == nullptr) {
+    return;
+  }
+  size_class.stats.slab_count++;
+
+  // Thread the new cells onto the free list, in address order
+  size_t cell_count = kSlabSize / cell_size;
+  for (size_t i = cell_count; i > 0; --i) {
+    FreeCell *cell = reinterpret_cast<FreeCell *>(slab + (i - 1) * cell_size);
+    cell->next = size_class.free_list;
+    size_class.free_list = cell;
+  }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// Statistics for one size class of the SizeClassPool. Shared with Dart, so
+// keep this layout in sync with `GDEPoolStats` in godot_dart_native_bridge.dart
+struct GDEPoolStats {
+  int64_t cell_size;
+  int64_t live_cells;
+  int64_t peak_cells;
+  int64_t total_allocations;
+  int64_t slab_count;
+};
+
+// A thread safe allocator for the small, short lived blocks that back Dart
+// builtin types. Blocks are grouped into size classes 16 bytes apart, and
+// each class carves cells out of slabs and recycles them through a free list,
+// so allocating and freeing is a lock and a pointer swap instead of a trip
+// through Godot's general allocator.
+//
+// Each cell is prefixed with its size class so blocks can be freed without
+// knowing their size. Blocks too large for any size class are allocated with
+// gde_mem_alloc directly. Slabs are never returned, they're reused for the
+// lifetime of the process.
+class SizeClassPool {
+public:
+  static const size_t kGranularity = 16;
+  static const size_t kSizeClassCount = 16;
+  static const size_t kMaxCellSize = kGranularity * kSizeClassCount;
+  static const size_t kSlabSize = 16 * 1024;
+
+  static SizeClassPool *instance();
+
+  void *alloc(size_t size);
+  void free(void *ptr);
+
+  // Returns false if `size_class` is out of range
+  bool get_stats(int32_t size_class, GDEPoolStats *stats);
+
+private:
+  SizeClassPool() = default;
+
+  struct FreeCell {
+    FreeCell *next;
+  };
+
+  struct SizeClass {
+    std::mutex lock;
+    FreeCell *free_list = nullptr;
+    GDEPoolStats stats = {};
+  };
+
+  void grow(SizeClass &size_class, size_t cell_size);
+
+  SizeClass _size_classes[kSizeClassCount];
+};
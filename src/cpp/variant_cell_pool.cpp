@@ -0,0 +1,81 @@
+#include "variant_cell_pool.h"
+
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/variant/variant.hpp>
+
+#include "gde_c_interface.h"
+
+// Keep the Variant itself 8 byte aligned
+#define CELL_HEADER_SIZE ((sizeof(Cell) + 7) & ~size_t(7))
+#define CELL_SIZE (CELL_HEADER_SIZE + ((sizeof(godot::Variant) + 7) & ~size_t(7)))
+
+VariantCellPool *VariantCellPool::instance() {
+  static VariantCellPool pool;
+  return &pool;
+}
+
+VariantCellPool::Cell *VariantCellPool::cell_from_variant(GDExtensionVariantPtr variant) {
+  return reinterpret_cast<Cell *>(reinterpret_cast<uint8_t *>(variant) - CELL_HEADER_SIZE);
+}
+
+GDExtensionVariantPtr VariantCellPool::variant_from_cell(Cell *cell) {
+  return reinterpret_cast<GDExtensionVariantPtr>(reinterpret_cast<uint8_t *>(cell) + CELL_HEADER_SIZE);
+}
+
+GDExtensionVariantPtr VariantCellPool::alloc() {
+  // Released cells aren't collected here, destroying them can free Objects
+  // and call back into Dart, which this (leaf) call must never do. Frame
+  // maintenance recycles them.
+  std::lock_guard<std::mutex> guard(_lock);
+  if (_free_list == nullptr) {
+    grow();
+  }
+  Cell *cell = _free_list;
+  _free_list = cell->next;
+  return variant_from_cell(cell);
+}
+
+void VariantCellPool::release(GDExtensionVariantPtr variant) {
+  if (variant == nullptr) {
+    return;
+  }
+
+  Cell *cell = cell_from_variant(variant);
+  cell->next = _pending.load(std::memory_order_relaxed);
+  while (!_pending.compare_exchange_weak(cell->next, cell, std::memory_order_release, std::memory_order_relaxed)) {
+  }
+}
+
+size_t VariantCellPool::collect() {
+  Cell *pending = _pending.exchange(nullptr, std::memory_order_acquire);
+  if (pending == nullptr) {
+    return 0;
+  }
+
+  // Destroy outside the lock, destroying a Variant can free Objects which may
+  // in turn release more Variants.
+  size_t count = 0;
+  Cell *last = pending;
+  for (Cell *cell = pending; cell != nullptr; cell = cell->next) {
+    gde_variant_destroy(variant_from_cell(cell));
+    last = cell;
+    count++;
+  }
+
+  std::lock_guard<std::mutex> guard(_lock);
+  last->next = _free_list;
+  _free_list = pending;
+
+  return count;
+}
+
+void VariantCellPool::grow() {
+  uint8_t *slab = reinterpret_cast<uint8_t *>(gde_mem_alloc(CELL_SIZE * kCellsPerSlab));
+  CRASH_COND_MSG(slab == nullptr, "GodotDart: Out of memory allocating Variant storage");
+
+  for (size_t i = kCellsPerSlab; i > 0; --i) {
+    Cell *cell = reinterpret_cast<Cell *>(slab + (i - 1) * CELL_SIZE);
+    cell->next = _free_list;
+    _free_list = cell;
+  }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include <gdextension_interface.h>
+
+// Storage for the Variants owned by Dart `Variant` objects.
+//
+// Cells come from slabs and are recycled through a free list. Dart's
+// finalizer doesn't destroy a Variant directly, it pushes the cell onto a
+// lock free pending list, and collect() later destroys and recycles every
+// pending cell in one batch. This keeps Variant destruction (which can
+// release Objects) off the GC thread and out of vararg-heavy call paths.
+class VariantCellPool {
+public:
+  static const size_t kCellsPerSlab = 256;
+
+  static VariantCellPool *instance();
+
+  // Returns uninitialized storage for a single Variant, growing the pool if
+  // needed. Never returns null and never calls into Dart.
+  GDExtensionVariantPtr alloc();
+  // Safe to call from any thread, including finalizers
+  void release(GDExtensionVariantPtr variant);
+  // Destroy every released Variant and return its cell to the free list.
+  // Returns the number of cells recycled. Destroying a Variant can free
+  // Objects, so this must be called from the Dart thread.
+  size_t collect();
+
+private:
+  VariantCellPool() = default;
+
+  struct Cell {
+    Cell *next;
+    // Followed by storage for the Variant
+  };
+
+  static Cell *cell_from_variant(GDExtensionVariantPtr variant);
+  static GDExtensionVariantPtr variant_from_cell(Cell *cell);
+
+  void grow();
+
+  std::mutex _lock;
+  Cell *_free_list = nullptr;
+  std::atomic<Cell *> _pending = nullptr;
+};
@@ -13,6 +13,7 @@ import 'src/variant/variant.dart';
 
 export 'src/annotations/godot_script.dart';
 export 'src/core/core_types.dart';
+export 'src/core/crossing_trace.dart';
 export 'src/core/gdextension.dart';
 export 'src/core/godot_dart_native_bridge.dart' hide variantPtrToDart;
 export 'src/core/property_info.dart';
@@ -20,8 +21,10 @@ export 'src/core/rpc_info.dart';
 export 'src/core/signals.dart' hide SignalCallable;
 export 'src/core/type_info.dart';
 export 'src/core/type_resolver.dart';
+export 'src/core/worker_pool.dart' hide startWorker, runThreadPoolTask;
 export 'src/extensions/async_extensions.dart';
 export 'src/extensions/core_extensions.dart';
+export 'src/extensions/packed_math_extensions.dart';
 export 'src/gen/builtins.dart';
 export 'src/gen/engine_classes.dart';
 export 'src/gen/global_constants.dart';
@@ -44,6 +47,11 @@ void _reloadCode() async {
   _isReloading = false;
 }
 
+@pragma('vm:entry-point')
+List<String>? _getChangedLibraries() {
+  return _reloader?.changedLibraries;
+}
+
 @pragma('vm:entry-point')
 void _registerGodot(int extensionToken) {
   final godotDart = DynamicLibrary.process();
@@ -56,7 +64,9 @@ void _registerGodot(int extensionToken) {
   initVariantBindings(ffiInterface, _globalExtension.typeResolver);
   PrimitiveTypeInfo.initTypeMappings();
   _globalExtension.typeResolver.addGodotBuiltins();
-  _globalExtension.typeResolver.addGodotStandardLibrary();
+  // Engine classes are registered lazily so only the classes the game actually
+  // touches pay for building their type info
+  _globalExtension.typeResolver.addGodotStandardLibraryLazy();
 
   GD.initBindings();
   SignalAwaiter.bind();
@@ -76,6 +86,17 @@ void _unregisterGodot() {
   _reloader?.stop();
 }
 
+@pragma('vm:entry-point')
+int _workerMain(int workerIndex) {
+  return startWorker(workerIndex);
+}
+
+@pragma('vm:entry-point')
+void _runThreadPoolTask(
+    Function task, int start, int end, int bufferAddress, int bufferLength) {
+  runThreadPoolTask(task, start, end, WorkerBuffer(bufferAddress, bufferLength));
+}
+
 typedef PrintClosure = void Function(String line);
 @pragma('vm:entry-point')
 PrintClosure _getPrintClosure() {
@@ -11,7 +11,11 @@ class GodotScript {
   /// for more information about Godot global classes
   final bool isGlobal;
 
-  const GodotScript({this.isGlobal = false});
+  /// Path to an icon (for example `res://icons/enemy.svg`) shown for this
+  /// class in the editor. Only used for global classes.
+  final String? icon;
+
+  const GodotScript({this.isGlobal = false, this.icon});
 }
 
 /// Export this method to Godot
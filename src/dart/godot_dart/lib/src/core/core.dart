@@ -1,12 +1,16 @@
 // Aggregate file for other core classes
 
 export 'core_types.dart';
+export 'crossing_trace.dart';
 export 'gdextension.dart';
 export 'gdextension_ffi_bindings.dart';
 export 'godot_dart_native_bridge.dart';
 export 'math_extensions.dart';
 export 'property_info.dart';
 export 'rpc_info.dart';
+export 'scratch_allocator.dart';
 export 'signals.dart';
+export 'type_descriptor.dart';
 export 'type_info.dart';
 export 'type_resolver.dart';
+export 'worker_pool.dart';
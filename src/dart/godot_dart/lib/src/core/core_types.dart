@@ -58,8 +58,9 @@ abstract class BuiltinType implements Finalizable {
   @protected
   Pointer<Uint8> allocateOpaque(
       int size, GDExtensionPtrDestructor? destructor) {
+    // Returned to the pool by finalizeBuiltinObject
     _opaque =
-        gde.ffiBindings.gde_mem_alloc(GodotDart.destructorSize + size).cast();
+        GDNativeInterface.poolAlloc(GodotDart.destructorSize + size).cast();
     _opaque.cast<GDExtensionPtrDestructor>().value = destructor ?? nullptr;
     return _opaque + GodotDart.destructorSize;
   }
@@ -0,0 +1,17 @@
+import 'godot_dart_native_bridge.dart';
+
+/// Access to the runtime's record of calls between Godot and Dart.
+///
+/// Tracing is enabled with the `dart/runtime/trace_crossings` project
+/// setting. While enabled, the most recent crossings (method calls, virtual
+/// calls, script property access, signals and finalizers) are recorded with
+/// their durations, and written to `dart/runtime/trace_path` at exit. Open
+/// the file in chrome://tracing or https://ui.perfetto.dev.
+abstract final class CrossingTrace {
+  static bool get isEnabled => GDNativeInterface.crossingTraceEnabled();
+
+  /// Write the crossings recorded so far to [path], which can be a `user://`
+  /// or `res://` path. Returns false if tracing was never enabled or the file
+  /// couldn't be written.
+  static bool dump(String path) => GDNativeInterface.crossingTraceDump(path);
+}
@@ -8,6 +8,7 @@ import '../variant/variant.dart';
 import 'core_types.dart';
 import 'gdextension_ffi_bindings.dart';
 import 'godot_dart_native_bridge.dart';
+import 'scratch_allocator.dart';
 import 'type_resolver.dart';
 
 GodotDart get gde => GodotDart.instance!;
@@ -39,16 +40,16 @@ class GodotDart {
     GDExtensionTypePtr base,
     List<GDExtensionConstTypePtr> args,
   ) {
-    final array = malloc<GDExtensionConstTypePtr>(args.length);
-    for (int i = 0; i < args.length; ++i) {
-      array[i] = args[i];
-    }
-
-    void Function(GDExtensionTypePtr, Pointer<GDExtensionConstTypePtr>) c =
-        constructor.asFunction();
-    c(base, array);
+    withScratch((arena) {
+      final array = arena<GDExtensionConstTypePtr>(args.length);
+      for (int i = 0; i < args.length; ++i) {
+        array[i] = args[i];
+      }
 
-    malloc.free(array);
+      void Function(GDExtensionTypePtr, Pointer<GDExtensionConstTypePtr>) c =
+          constructor.asFunction();
+      c(base, array);
+    });
   }
 
   void callBuiltinDestructor(
@@ -65,14 +66,15 @@ class GodotDart {
   ) {
     if (method == null) return;
 
-    final array = malloc<GDExtensionConstTypePtr>(args.length);
-    for (int i = 0; i < args.length; ++i) {
-      array[i] = args[i];
-    }
-    void Function(GDExtensionTypePtr, Pointer<GDExtensionConstTypePtr>,
-        GDExtensionTypePtr, int) m = method.asFunction();
-    m(base, array, ret, args.length);
-    malloc.free(array);
+    withScratch((arena) {
+      final array = arena<GDExtensionConstTypePtr>(args.length);
+      for (int i = 0; i < args.length; ++i) {
+        array[i] = args[i];
+      }
+      void Function(GDExtensionTypePtr, Pointer<GDExtensionConstTypePtr>,
+          GDExtensionTypePtr, int) m = method.asFunction();
+      m(base, array, ret, args.length);
+    });
   }
 
   Variant callNativeMethodBind(
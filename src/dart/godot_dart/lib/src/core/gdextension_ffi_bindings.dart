@@ -802,6 +802,44 @@ class GDExtensionFFI {
           void Function(GDExtensionMethodBindPtr, GDExtensionObjectPtr,
               ffi.Pointer<GDExtensionConstTypePtr>, GDExtensionTypePtr)>();
 
+  void gde_object_method_bind_ptrcall_batch(
+    GDExtensionMethodBindPtr p_method_bind,
+    ffi.Pointer<GDExtensionObjectPtr> p_instances,
+    int p_count,
+    ffi.Pointer<GDExtensionConstTypePtr> p_args,
+    int p_arg_stride,
+    ffi.Pointer<GDExtensionTypePtr> r_rets,
+  ) {
+    return _gde_object_method_bind_ptrcall_batch(
+      p_method_bind,
+      p_instances,
+      p_count,
+      p_args,
+      p_arg_stride,
+      r_rets,
+    );
+  }
+
+  late final _gde_object_method_bind_ptrcall_batchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(
+              GDExtensionMethodBindPtr,
+              ffi.Pointer<GDExtensionObjectPtr>,
+              GDExtensionInt,
+              ffi.Pointer<GDExtensionConstTypePtr>,
+              GDExtensionInt,
+              ffi.Pointer<GDExtensionTypePtr>)>>(
+      'gde_object_method_bind_ptrcall_batch');
+  late final _gde_object_method_bind_ptrcall_batch =
+      _gde_object_method_bind_ptrcall_batchPtr.asFunction<
+          void Function(
+              GDExtensionMethodBindPtr,
+              ffi.Pointer<GDExtensionObjectPtr>,
+              int,
+              ffi.Pointer<GDExtensionConstTypePtr>,
+              int,
+              ffi.Pointer<GDExtensionTypePtr>)>();
+
   ffi.Pointer<ffi.Void> gde_object_get_instance_binding(
     GDExtensionObjectPtr p_o,
     ffi.Pointer<ffi.Void> p_token,
@@ -36,6 +36,123 @@ sealed class GDNativeInterface {
   @Native<Handle Function(Pointer<Void>)>(symbol: 'gd_object_to_dart_object')
   external static Object? gdObjectToDartObject(Pointer<Void> objectPtr);
 
+  @Native<Pointer<Void> Function(Size)>(symbol: 'gde_pool_alloc', isLeaf: true)
+  external static Pointer<Void> poolAlloc(int size);
+
+  @Native<Void Function(Pointer<Void>)>(symbol: 'gde_pool_free', isLeaf: true)
+  external static void poolFree(Pointer<Void> ptr);
+
+  @Native<Uint64 Function()>(symbol: 'gde_scratch_mark', isLeaf: true)
+  external static int scratchMark();
+
+  @Native<Pointer<Void> Function(Size, Size)>(
+      symbol: 'gde_scratch_alloc', isLeaf: true)
+  external static Pointer<Void> scratchAlloc(int size, int alignment);
+
+  @Native<Void Function(Uint64)>(symbol: 'gde_scratch_reset', isLeaf: true)
+  external static void scratchReset(int mark);
+
+  @Native<Int32 Function()>(symbol: 'gde_pool_size_class_count', isLeaf: true)
+  external static int poolSizeClassCount();
+
+  @Native<Bool Function(Int32, Pointer<GDEPoolStats>)>(
+      symbol: 'gde_pool_get_stats', isLeaf: true)
+  external static bool poolGetStats(int sizeClass, Pointer<GDEPoolStats> stats);
+
+  /// Index of the worker isolate that should take the next job, or -1 if
+  /// none are running. Pair with [workerPoolRelease].
+  @Native<Int32 Function()>(symbol: 'gde_worker_pool_acquire', isLeaf: true)
+  external static int workerPoolAcquire();
+
+  @Native<Void Function(Int32)>(symbol: 'gde_worker_pool_release', isLeaf: true)
+  external static void workerPoolRelease(int worker);
+
+  @Native<Handle Function(Int32)>(symbol: 'gde_worker_pool_send_port')
+  external static Object? workerPoolSendPort(int worker);
+
+  /// Writable pointer to the elements of a packed array. [sizeInBytes] is set
+  /// to -1 if the array's elements aren't plain data.
+  @Native<Pointer<Void> Function(Pointer<Void>, Int32, Pointer<Int64>)>(
+      symbol: 'gde_packed_array_data', isLeaf: true)
+  external static Pointer<Void> packedArrayData(
+      Pointer<Void> packedArray, int variantType, Pointer<Int64> sizeInBytes);
+
+  @Native<Bool Function()>(symbol: 'gde_crossing_trace_enabled', isLeaf: true)
+  external static bool crossingTraceEnabled();
+
+  @Native<Bool Function(Handle)>(symbol: 'gde_crossing_trace_dump')
+  external static bool crossingTraceDump(String path);
+
+  @Native<Void Function(Pointer<Void>, Pointer<Void>)>(
+      symbol: 'gde_packed_vector2_transform', isLeaf: true)
+  external static void packedVector2Transform(
+      Pointer<Void> packedArray, Pointer<Void> transform);
+
+  @Native<Void Function(Pointer<Void>, Pointer<Void>)>(
+      symbol: 'gde_packed_vector3_transform', isLeaf: true)
+  external static void packedVector3Transform(
+      Pointer<Void> packedArray, Pointer<Void> transform);
+
+  @Native<Bool Function(Pointer<Void>, Pointer<Void>, Int32, Float)>(
+      symbol: 'gde_packed_array_lerp', isLeaf: true)
+  external static bool packedArrayLerp(Pointer<Void> packedArray,
+      Pointer<Void> to, int variantType, double weight);
+
+  @Native<Void Function(Pointer<Void>)>(
+      symbol: 'gde_packed_vector2_normalize', isLeaf: true)
+  external static void packedVector2Normalize(Pointer<Void> packedArray);
+
+  @Native<Void Function(Pointer<Void>)>(
+      symbol: 'gde_packed_vector3_normalize', isLeaf: true)
+  external static void packedVector3Normalize(Pointer<Void> packedArray);
+
+  @Native<Void Function(Pointer<Void>, Pointer<Void>, Pointer<Void>)>(
+      symbol: 'gde_packed_vector2_distance_to', isLeaf: true)
+  external static void packedVector2DistanceTo(
+      Pointer<Void> packedArray, Pointer<Void> point, Pointer<Void> distances);
+
+  @Native<Void Function(Pointer<Void>, Pointer<Void>, Pointer<Void>)>(
+      symbol: 'gde_packed_vector3_distance_to', isLeaf: true)
+  external static void packedVector3DistanceTo(
+      Pointer<Void> packedArray, Pointer<Void> point, Pointer<Void> distances);
+
+  @Native<Void Function(Pointer<Void>, Pointer<Void>, Pointer<Void>)>(
+      symbol: 'gde_packed_vector3_cull_aabb', isLeaf: true)
+  external static void packedVector3CullAabb(
+      Pointer<Void> packedArray, Pointer<Void> aabb, Pointer<Void> indices);
+
+  /// Returns -1 if [task] isn't a top-level or static function
+  @Native<Int64 Function(Handle, Int64, Int64, Bool, Handle)>(
+      symbol: 'gde_thread_pool_add_task')
+  external static int threadPoolAddTask(Function task, int bufferAddress,
+      int bufferLength, bool highPriority, String description);
+
+  /// Returns -1 if [task] isn't a top-level or static function
+  @Native<Int64 Function(Handle, Int64, Int64, Int32, Int64, Int64, Bool, Handle)>(
+      symbol: 'gde_thread_pool_add_group_task')
+  external static int threadPoolAddGroupTask(
+      Function task,
+      int elementCount,
+      int batchSize,
+      int tasksNeeded,
+      int bufferAddress,
+      int bufferLength,
+      bool highPriority,
+      String description);
+
+  // These must not be leaf calls, helper isolates can't garbage collect while
+  // this isolate is blocked in a leaf call
+  @Native<Void Function(Int64)>(symbol: 'gde_thread_pool_wait_task')
+  external static void threadPoolWaitTask(int taskId);
+
+  @Native<Void Function(Int64)>(symbol: 'gde_thread_pool_wait_group_task')
+  external static void threadPoolWaitGroupTask(int groupId);
+
+  /// Storage for a single Variant, released with [finalizeVariant]
+  @Native<Pointer<Void> Function()>(
+      symbol: 'gde_variant_pool_alloc', isLeaf: true)
+  external static Pointer<Void> variantPoolAlloc();
+
   @Native<Void Function(Pointer<Void>)>(symbol: 'finalize_variant')
   external static void finalizeVariant(Pointer<Void> variant);
 
@@ -68,9 +185,24 @@ sealed class GDNativeInterface {
   external static GDExtensionScriptInstanceDataPtr getScriptInstance(
       GDExtensionConstObjectPtr ptr);
 
-  @Native<Handle Function(Handle, Int64)>(symbol: 'create_signal_callable')
+  @Native<Handle Function(Handle, Int64, Bool)>(symbol: 'create_signal_callable')
   external static Object createSignalCallable(
-      SignalCallable callable, int instanceId);
+      SignalCallable callable, int instanceId, bool deferred);
+}
+
+/// Statistics for one size class of the native pool that backs [BuiltinType]
+/// storage. Matches `GDEPoolStats` in size_class_pool.h
+final class GDEPoolStats extends Struct {
+  @Int64()
+  external int cellSize;
+  @Int64()
+  external int liveCells;
+  @Int64()
+  external int peakCells;
+  @Int64()
+  external int totalAllocations;
+  @Int64()
+  external int slabCount;
 }
 
 @pragma('vm:entry-point')
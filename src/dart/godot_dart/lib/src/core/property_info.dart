@@ -1,3 +1,5 @@
+import 'dart:typed_data';
+
 import 'package:meta/meta.dart';
 
 import '../gen/builtins.dart';
@@ -5,6 +7,7 @@ import '../gen/global_constants.dart';
 import '../variant/variant.dart';
 import 'type_info.dart';
 import 'gdextension.dart';
+import 'type_descriptor.dart';
 
 @immutable
 class PropertyInfo {
@@ -31,6 +34,15 @@ class PropertyInfo {
     this.flags = 6, // PropertyUsage.propertyUsageDefault
   });
 
+  /// Serialize this property into a flat buffer. See [TypeDescriptorWriter]
+  /// for the layout.
+  @pragma('vm:entry-point')
+  Uint8List toDescriptor() {
+    final writer = TypeDescriptorWriter();
+    writer.writeProperty(this);
+    return writer.takeBytes();
+  }
+
   Dictionary asDict() {
     final dict = Dictionary();
 
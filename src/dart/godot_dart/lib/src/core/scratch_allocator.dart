@@ -0,0 +1,43 @@
+import 'dart:ffi';
+
+import 'godot_dart_native_bridge.dart';
+
+/// An [Allocator] backed by a native, thread local bump allocator.
+///
+/// Memory allocated from it is only valid until the enclosing [withScratch]
+/// returns. [free] does nothing, everything is released at once when the
+/// block ends. Use this for argument slots and return values of native calls
+/// instead of an `Arena`, which mallocs and frees every allocation.
+final class ScratchAllocator implements Allocator {
+  const ScratchAllocator._();
+
+  @override
+  Pointer<T> allocate<T extends NativeType>(int byteCount, {int? alignment}) {
+    final ptr = GDNativeInterface.scratchAlloc(byteCount, alignment ?? 8);
+    if (ptr == nullptr) {
+      throw ArgumentError(
+          'Could not allocate $byteCount bytes of scratch memory');
+    }
+    return ptr.cast();
+  }
+
+  @override
+  void free(Pointer<NativeType> pointer) {}
+}
+
+const scratchAllocator = ScratchAllocator._();
+
+/// Runs [computation] with the [scratchAllocator], releasing everything it
+/// allocated when it returns.
+///
+/// This is a drop in replacement for `package:ffi`'s `using`, but only for
+/// synchronous code. [computation] must not return a `Future` that uses the
+/// scratch memory.
+R withScratch<R>(R Function(Allocator) computation) {
+  final mark = GDNativeInterface.scratchMark();
+  try {
+    return computation(scratchAllocator);
+  } finally {
+    GDNativeInterface.scratchReset(mark);
+  }
+}
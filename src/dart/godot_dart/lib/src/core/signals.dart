@@ -85,7 +85,13 @@ abstract class SignalCallable {
   final int arguments;
   final Signal signal;
 
-  SignalCallable(GodotObject object, this.name, this.arguments)
+  /// If true, emissions from threads other than the main thread are queued
+  /// and delivered during the next frame, instead of the emitting thread
+  /// waiting until Dart is free to run the handlers immediately.
+  final bool deferred;
+
+  SignalCallable(GodotObject object, this.name, this.arguments,
+      {this.deferred = false})
       : signal = Signal.fromObjectSignal(object, name) {
     final callable = _createSignalCallableBinding(this, object);
     object.connect(name, callable);
@@ -95,7 +101,7 @@ abstract class SignalCallable {
   Callable _createSignalCallableBinding(
       SignalCallable callable, GodotObject binding) {
     final result = GDNativeInterface.createSignalCallable(
-        callable, binding.getInstanceId());
+        callable, binding.getInstanceId(), deferred);
     return result as Callable;
   }
 
@@ -106,7 +112,8 @@ abstract class SignalCallable {
 class Signal0 extends SignalCallable {
   late _SubscriptionMap<void Function()> _subscriptions;
 
-  Signal0(GodotObject object, String name) : super(object, name, 0) {
+  Signal0(GodotObject object, String name, {bool deferred = false})
+      : super(object, name, 0, deferred: deferred) {
     _subscriptions = _SubscriptionMap<void Function()>(this);
   }
 
@@ -156,7 +163,8 @@ class Signal0 extends SignalCallable {
 class Signal1<P1> extends SignalCallable {
   late _SubscriptionMap<void Function(P1)> _subscriptions;
 
-  Signal1(GodotObject object, String name) : super(object, name, 1) {
+  Signal1(GodotObject object, String name, {bool deferred = false})
+      : super(object, name, 1, deferred: deferred) {
     _subscriptions = _SubscriptionMap<void Function(P1)>(this);
   }
 
@@ -206,7 +214,8 @@ class Signal1<P1> extends SignalCallable {
 class Signal2<P1, P2> extends SignalCallable {
   late _SubscriptionMap<void Function(P1, P2)> _subscriptions;
 
-  Signal2(GodotObject object, String name) : super(object, name, 2) {
+  Signal2(GodotObject object, String name, {bool deferred = false})
+      : super(object, name, 2, deferred: deferred) {
     _subscriptions = _SubscriptionMap<void Function(P1, P2)>(this);
   }
 
@@ -262,7 +271,8 @@ class Signal2<P1, P2> extends SignalCallable {
 class Signal3<P1, P2, P3> extends SignalCallable {
   late _SubscriptionMap<void Function(P1, P2, P3)> _subscriptions;
 
-  Signal3(GodotObject object, String name) : super(object, name, 3) {
+  Signal3(GodotObject object, String name, {bool deferred = false})
+      : super(object, name, 3, deferred: deferred) {
     _subscriptions = _SubscriptionMap<void Function(P1, P2, P3)>(this);
   }
 
@@ -320,7 +330,8 @@ class Signal3<P1, P2, P3> extends SignalCallable {
 class Signal4<P1, P2, P3, P4> extends SignalCallable {
   late _SubscriptionMap<void Function(P1, P2, P3, P4)> _subscriptions;
 
-  Signal4(GodotObject object, String name) : super(object, name, 3) {
+  Signal4(GodotObject object, String name, {bool deferred = false})
+      : super(object, name, 3, deferred: deferred) {
     _subscriptions = _SubscriptionMap<void Function(P1, P2, P3, P4)>(this);
   }
 
@@ -380,7 +391,8 @@ class Signal4<P1, P2, P3, P4> extends SignalCallable {
 class Signal5<P1, P2, P3, P4, P5> extends SignalCallable {
   late _SubscriptionMap<void Function(P1, P2, P3, P4, P5)> _subscriptions;
 
-  Signal5(GodotObject object, String name) : super(object, name, 5) {
+  Signal5(GodotObject object, String name, {bool deferred = false})
+      : super(object, name, 5, deferred: deferred) {
     _subscriptions = _SubscriptionMap<void Function(P1, P2, P3, P4, P5)>(this);
   }
 
@@ -0,0 +1,110 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'gdextension.dart';
+import 'property_info.dart';
+import 'rpc_info.dart';
+import 'type_info.dart';
+
+/// Version of the descriptor layout. Must match `TYPE_DESCRIPTOR_VERSION` in
+/// gde_dart_converters.h
+const int typeDescriptorVersion = 2;
+
+/// Writes type metadata into a single flat buffer so native code can read
+/// it in one pass instead of calling back into Dart for every field.
+///
+/// All integers are native-endian. The layout is:
+///
+/// ```
+/// string:   u32 byteLength, utf8 bytes (no terminator)
+/// property: u8 hasTypeInfo, [u32 variantType, string className],
+///           string name, u32 hint, string hintString, u32 usage
+/// method:   string name, u32 flags, u8 hasReturn, [property returnInfo],
+///           u32 argCount, property[argCount] args
+/// signal:   string name, u32 flags, u32 argCount, property[argCount] args
+/// rpc:      string name, u32 rpcMode, u8 callLocal, u32 transferMode,
+///           u32 channel
+///
+/// type:     u32 version, string className, string nativeTypeName,
+///           u8 isGlobalClass,
+///           u32 propertyCount, property[propertyCount],
+///           u32 methodCount, method[methodCount],
+///           u32 signalCount, signal[signalCount],
+///           u32 rpcCount, rpc[rpcCount]
+/// ```
+class TypeDescriptorWriter {
+  final BytesBuilder _builder = BytesBuilder(copy: false);
+  final ByteData _scratch = ByteData(4);
+
+  Uint8List takeBytes() => _builder.takeBytes();
+
+  void writeUint8(int value) {
+    _builder.addByte(value);
+  }
+
+  void writeUint32(int value) {
+    _scratch.setUint32(0, value, Endian.host);
+    _builder.add(_scratch.buffer.asUint8List(0, 4));
+  }
+
+  void writeString(String value) {
+    final bytes = utf8.encode(value);
+    writeUint32(bytes.length);
+    _builder.add(bytes);
+  }
+
+  void writeProperty(PropertyInfo info) {
+    final typeInfo = gde.typeResolver.getTypeInfoByType(info.type);
+    writeUint8(typeInfo != null ? 1 : 0);
+    if (typeInfo != null) {
+      writeUint32(typeInfo.variantType);
+      writeString(typeInfo.className.toDartString());
+    }
+    writeString(info.name);
+    writeUint32(info.hint.value);
+    writeString(info.hintString);
+    writeUint32(info.flags);
+  }
+
+  void writeMethod(MethodInfo<dynamic> info) {
+    writeString(info.name);
+    writeUint32(info.flags.value);
+    final returnInfo = info.returnInfo;
+    writeUint8(returnInfo != null ? 1 : 0);
+    if (returnInfo != null) {
+      writeProperty(returnInfo);
+    }
+    writeUint32(info.args.length);
+    info.args.forEach(writeProperty);
+  }
+
+  void writeSignal(SignalInfo info) {
+    writeString(info.name);
+    writeUint32(info.flags.value);
+    writeUint32(info.args.length);
+    info.args.forEach(writeProperty);
+  }
+
+  void writeRpc(RpcInfo info) {
+    writeString(info.name);
+    writeUint32(info.mode.value);
+    writeUint8(info.callLocal ? 1 : 0);
+    writeUint32(info.transferMode.value);
+    writeUint32(info.transferChannel);
+  }
+
+  void writeType(ExtensionTypeInfo<dynamic> info) {
+    writeUint32(typeDescriptorVersion);
+    writeString(info.className.toDartString());
+    writeString(info.nativeTypeName.toDartString());
+    writeUint8(info.isGlobalClass ? 1 : 0);
+    writeUint32(info.properties.length);
+    info.properties.forEach(writeProperty);
+    writeUint32(info.methods.length);
+    info.methods.forEach(writeMethod);
+    writeUint32(info.signals.length);
+    info.signals.forEach(writeSignal);
+    writeUint32(info.rpcInfo.length);
+    info.rpcInfo.forEach(writeRpc);
+  }
+}
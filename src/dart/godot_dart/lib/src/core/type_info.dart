@@ -1,4 +1,5 @@
 import 'dart:ffi';
+import 'dart:typed_data';
 
 import 'package:collection/collection.dart';
 import 'package:meta/meta.dart';
@@ -8,6 +9,7 @@ import '../gen/global_constants.dart';
 import '../variant/array.dart';
 import '../variant/variant.dart';
 import 'core.dart';
+import 'type_descriptor.dart';
 
 // In order to avoid having to place @pragma('vm:entry-point') on
 // every method in Godot, use a function that we can get and invoke
@@ -358,6 +360,9 @@ class ExtensionTypeInfo<T> implements TypeInfo {
   @pragma('vm:entry-point')
   final bool isGlobalClass;
 
+  /// Editor icon for global classes, if any.
+  final String? iconPath;
+
   // TODO: We can likely make this work better by having a ScriptTypeInfo that
   // inherits from ExtensionTypeInfo instead of this flag.
   @pragma('vm:entry-point')
@@ -377,6 +382,7 @@ class ExtensionTypeInfo<T> implements TypeInfo {
     this.properties = const [],
     this.rpcInfo = const [],
     this.isGlobalClass = false,
+    this.iconPath,
     this.isScript = false,
   });
 
@@ -405,6 +411,15 @@ class ExtensionTypeInfo<T> implements TypeInfo {
     return null;
   }
 
+  /// Serialize this type's properties, methods, signals and RPC config into
+  /// a flat buffer. See [TypeDescriptorWriter] for the layout.
+  @pragma('vm:entry-point')
+  Uint8List toDescriptor() {
+    final writer = TypeDescriptorWriter();
+    writer.writeType(this);
+    return writer.takeBytes();
+  }
+
   @pragma('vm:entry-point')
   PropertyInfo? getPropertyInfo(String propertyName) {
     ExtensionTypeInfo<dynamic>? searchTypeInfo = this;
@@ -17,6 +17,10 @@ class TypeResolver {
   final Map<String, TypeInfo> _stringTypeInfoLookup = {};
   final Map<Type, TypeInfo> _typeTypeInfoLookup = {};
 
+  // Types registered with [addLazyTypes] that haven't been looked up yet
+  final Map<String, TypeInfo Function()> _lazyStringTypeInfoLookup = {};
+  final Map<Type, TypeInfo Function()> _lazyTypeTypeInfoLookup = {};
+
   @pragma('vm:entry-point')
   String? scriptPathFromType(Type type) {
     return _scriptTypeFileMap[type];
@@ -27,6 +31,57 @@ class TypeResolver {
     return _scriptFileTypeMap[path];
   }
 
+  /// Every registered script, flattened into groups of four so native code
+  /// can resolve all scripts with one call:
+  /// `[path, type, typeInfo, baseScriptPath or null, ...]`
+  @pragma('vm:entry-point')
+  List<Object?> getScriptTypeTable() {
+    final table = <Object?>[];
+    for (final entry in _scriptFileTypeMap.entries) {
+      final typeInfo = _typeTypeInfoLookup[entry.value];
+      final parentType = (typeInfo as ExtensionTypeInfo?)?.parentTypeInfo?.type;
+      table
+        ..add(entry.key)
+        ..add(entry.value)
+        ..add(typeInfo)
+        ..add(parentType != null ? _scriptTypeFileMap[parentType] : null);
+    }
+    return table;
+  }
+
+  /// Everything Godot needs to know about global classes, flattened into
+  /// groups of four: `[path, name, baseType, iconPath, ...]`
+  @pragma('vm:entry-point')
+  List<String> getGlobalClassTable() {
+    final table = <String>[];
+    for (final path in _globalClassPaths) {
+      final typeInfo =
+          _typeTypeInfoLookup[_scriptFileTypeMap[path]] as ExtensionTypeInfo?;
+      if (typeInfo == null) continue;
+
+      // The base type is the closest parent that is either native or another
+      // global class
+      final nativeTypeName = typeInfo.nativeTypeName.toDartString();
+      var baseType = nativeTypeName;
+      var parent = typeInfo.parentTypeInfo;
+      while (parent != null) {
+        final parentName = parent.className.toDartString();
+        if (parentName == nativeTypeName || parent.isGlobalClass) {
+          baseType = parentName;
+          break;
+        }
+        parent = parent.parentTypeInfo;
+      }
+
+      table
+        ..add(path)
+        ..add(typeInfo.className.toDartString())
+        ..add(baseType)
+        ..add(typeInfo.iconPath ?? '');
+    }
+    return table;
+  }
+
   @pragma('vm:entry-point')
   List<String> getGlobalClassPaths() {
     // Native code is expecting a list
@@ -35,13 +90,15 @@ class TypeResolver {
 
   @pragma('vm:entry-point')
   TypeInfo? getTypeInfoByName(String typeName) {
-    final ret = _stringTypeInfoLookup[typeName];
+    final ret = _stringTypeInfoLookup[typeName] ??
+        _resolveLazyType(_lazyStringTypeInfoLookup[typeName]);
     return ret;
   }
 
   @pragma('vm:entry-point')
   TypeInfo? getTypeInfoByType(Type type) {
-    var info = _typeTypeInfoLookup[type];
+    var info = _typeTypeInfoLookup[type] ??
+        _resolveLazyType(_lazyTypeTypeInfoLookup[type]);
     if (info != null) return info;
     // Not found, try the a primitive type
     info = PrimitiveTypeInfo.forType(type);
@@ -74,6 +131,24 @@ class TypeResolver {
     assert(!_stringTypeInfoLookup.containsKey(dartName));
     _stringTypeInfoLookup[dartName] = typeInfo;
     _typeTypeInfoLookup[typeInfo.type] = typeInfo;
+    _lazyStringTypeInfoLookup.remove(dartName);
+    _lazyTypeTypeInfoLookup.remove(typeInfo.type);
+  }
+
+  /// Register types that are only created (and added with [addType]) the
+  /// first time they are looked up by name or by type. Both maps should
+  /// contain the same factories.
+  void addLazyTypes(Map<String, TypeInfo Function()> byName,
+      Map<Type, TypeInfo Function()> byType) {
+    _lazyStringTypeInfoLookup.addAll(byName);
+    _lazyTypeTypeInfoLookup.addAll(byType);
+  }
+
+  TypeInfo? _resolveLazyType(TypeInfo Function()? factory) {
+    if (factory == null) return null;
+    final typeInfo = factory();
+    addType(typeInfo);
+    return typeInfo;
   }
 
   void addGodotBuiltins() {
@@ -0,0 +1,304 @@
+import 'dart:async';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:isolate';
+import 'dart:math';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:meta/meta.dart';
+
+import 'core_types.dart';
+import 'godot_dart_native_bridge.dart';
+import 'scratch_allocator.dart';
+
+/// A block of native memory passed to a worker job by address, so its
+/// contents are never copied.
+///
+/// The memory must stay valid until the job completes. Packed arrays given to
+/// [WorkerPool.run] are kept alive for that long, raw pointers are the
+/// caller's responsibility.
+final class WorkerBuffer {
+  final int address;
+  final int lengthInBytes;
+
+  const WorkerBuffer(this.address, this.lengthInBytes);
+
+  WorkerBuffer.fromPointer(Pointer<NativeType> pointer, this.lengthInBytes)
+      : address = pointer.address;
+
+  Pointer<T> pointer<T extends NativeType>() => Pointer<T>.fromAddress(address);
+
+  Uint8List asUint8List() => lengthInBytes == 0
+      ? Uint8List(0)
+      : pointer<Uint8>().asTypedList(lengthInBytes);
+
+  Int32List asInt32List() => lengthInBytes == 0
+      ? Int32List(0)
+      : pointer<Int32>().asTypedList(lengthInBytes ~/ 4);
+
+  Int64List asInt64List() => lengthInBytes == 0
+      ? Int64List(0)
+      : pointer<Int64>().asTypedList(lengthInBytes ~/ 8);
+
+  Float32List asFloat32List() => lengthInBytes == 0
+      ? Float32List(0)
+      : pointer<Float>().asTypedList(lengthInBytes ~/ 4);
+
+  Float64List asFloat64List() => lengthInBytes == 0
+      ? Float64List(0)
+      : pointer<Double>().asTypedList(lengthInBytes ~/ 8);
+}
+
+/// A job run on a worker isolate. It receives the buffers passed to
+/// [WorkerPool.run] in the same order.
+typedef WorkerJob<R> = FutureOr<R> Function(List<WorkerBuffer> buffers);
+
+final class _WorkerRequest {
+  final int id;
+  final FutureOr<Object?> Function(List<WorkerBuffer>) job;
+  final List<WorkerBuffer> buffers;
+  final SendPort replyPort;
+
+  _WorkerRequest(this.id, this.job, this.buffers, this.replyPort);
+}
+
+final class _WorkerReply {
+  final int id;
+  final Object? result;
+  final RemoteError? error;
+
+  _WorkerReply(this.id, this.result) : error = null;
+  _WorkerReply.error(this.id, this.error) : result = null;
+}
+
+final class _PendingJob<R> {
+  final int worker;
+  final completer = Completer<R>();
+  // Keeps packed arrays alive while the worker is using their memory
+  // ignore: unused_field
+  final List<Object> _buffers;
+
+  _PendingJob(this.worker, this._buffers);
+
+  void complete(_WorkerReply reply) {
+    final error = reply.error;
+    if (error != null) {
+      completer.completeError(error, error.stackTrace);
+    } else {
+      completer.complete(reply.result as R);
+    }
+  }
+}
+
+/// Runs CPU heavy Dart code on background isolates.
+///
+/// The worker isolates are started by the runtime, the number is set with the
+/// `dart/runtime/worker_isolates` project setting. They share the main
+/// isolate's program, so jobs can be closures, but they can't use Godot. A job
+/// can only work with the [WorkerBuffer]s it's given and the values it
+/// captures (which are copied to the worker).
+///
+/// Results are delivered back to the main isolate during frame processing.
+class WorkerPool {
+  static final WorkerPool instance = WorkerPool._();
+
+  final RawReceivePort _replyPort = RawReceivePort();
+  final Map<int, _PendingJob<dynamic>> _pending = {};
+  final Map<int, SendPort> _workerPorts = {};
+  int _nextJobId = 0;
+
+  WorkerPool._() {
+    _replyPort.handler = _handleReply;
+  }
+
+  /// Run [job] on the least busy worker isolate.
+  ///
+  /// Each entry of [buffers] is either a [WorkerBuffer] or a packed array
+  /// (such as [PackedFloat32Array]) whose elements are passed without being
+  /// copied. Packed arrays must not be resized until the job completes.
+  Future<R> run<R>(WorkerJob<R> job, {List<Object> buffers = const []}) {
+    final workerBuffers = buffers.map(_toWorkerBuffer).toList(growable: false);
+
+    final worker = GDNativeInterface.workerPoolAcquire();
+    if (worker < 0) {
+      return Future.error(StateError('No worker isolates are running'));
+    }
+    var port = _workerPorts[worker];
+    if (port == null) {
+      // Waits for the worker to finish starting, the first time it's used
+      port = GDNativeInterface.workerPoolSendPort(worker) as SendPort?;
+      if (port == null) {
+        GDNativeInterface.workerPoolRelease(worker);
+        return Future.error(
+            StateError('Worker isolate $worker failed to start'));
+      }
+      _workerPorts[worker] = port;
+    }
+
+    final id = _nextJobId++;
+    final pending = _PendingJob<R>(worker, buffers);
+    _pending[id] = pending;
+    try {
+      port.send(_WorkerRequest(id, job, workerBuffers, _replyPort.sendPort));
+    } catch (_) {
+      // Usually because the job captured something that can't be sent
+      _pending.remove(id);
+      GDNativeInterface.workerPoolRelease(worker);
+      rethrow;
+    }
+
+    return pending.completer.future;
+  }
+
+  void _handleReply(Object? message) {
+    final reply = message as _WorkerReply;
+    final pending = _pending.remove(reply.id);
+    if (pending == null) {
+      return;
+    }
+    GDNativeInterface.workerPoolRelease(pending.worker);
+    pending.complete(reply);
+  }
+}
+
+/// Runs Dart functions as tasks on Godot's `WorkerThreadPool`, sharing the
+/// engine's threads rather than starting more.
+///
+/// Each pool thread runs tasks in its own helper isolate, so like
+/// [WorkerPool] jobs, tasks can't use Godot and share data through a
+/// [WorkerBuffer]. Tasks must be top-level or static functions, as they're
+/// looked up by name in the helper isolate. Packed arrays passed as `buffer`
+/// must stay alive, and not be resized, until the task completes.
+abstract final class ThreadPoolTasks {
+  /// Returns the `WorkerThreadPool` task id
+  static int addTask(void Function(WorkerBuffer buffer) task,
+      {Object? buffer, bool highPriority = false, String description = ''}) {
+    final workerBuffer = _toWorkerBuffer(buffer);
+    return _checkId(GDNativeInterface.threadPoolAddTask(task,
+        workerBuffer.address, workerBuffer.lengthInBytes, highPriority, description));
+  }
+
+  /// Call [task] for every index in `[0, elements)`. Indices are handed to
+  /// pool threads [batchSize] at a time. Returns the `WorkerThreadPool` group
+  /// id.
+  static int addGroupTask(
+      void Function(int index, WorkerBuffer buffer) task, int elements,
+      {Object? buffer,
+      int batchSize = 1,
+      int tasksNeeded = -1,
+      bool highPriority = false,
+      String description = ''}) {
+    return _addGroupTask(task, elements, batchSize, tasksNeeded, buffer,
+        highPriority, description);
+  }
+
+  /// Split `[0, count)` into ranges and call [body] on each from the pool,
+  /// returning once every range is done. By default the range is split into
+  /// a few batches per core.
+  static void parallelFor(
+      int count, void Function(int start, int end, WorkerBuffer buffer) body,
+      {Object? buffer, int? batchSize}) {
+    if (count <= 0) {
+      return;
+    }
+    batchSize ??= max(1, count ~/ (Platform.numberOfProcessors * 4));
+    final groupId = _addGroupTask(
+        body, count, batchSize, -1, buffer, true, 'Dart parallelFor');
+    waitForGroupTask(groupId);
+  }
+
+  static void waitForTask(int taskId) {
+    GDNativeInterface.threadPoolWaitTask(taskId);
+  }
+
+  static void waitForGroupTask(int groupId) {
+    GDNativeInterface.threadPoolWaitGroupTask(groupId);
+  }
+
+  static int _addGroupTask(Function task, int elements, int batchSize,
+      int tasksNeeded, Object? buffer, bool highPriority, String description) {
+    final workerBuffer = _toWorkerBuffer(buffer);
+    return _checkId(GDNativeInterface.threadPoolAddGroupTask(
+        task,
+        elements,
+        batchSize,
+        tasksNeeded,
+        workerBuffer.address,
+        workerBuffer.lengthInBytes,
+        highPriority,
+        description));
+  }
+
+  static int _checkId(int id) {
+    if (id < 0) {
+      throw ArgumentError('Thread pool tasks must be top-level or static functions');
+    }
+    return id;
+  }
+}
+
+WorkerBuffer _toWorkerBuffer(Object? buffer) {
+  if (buffer == null) {
+    return const WorkerBuffer(0, 0);
+  }
+  if (buffer is WorkerBuffer) {
+    return buffer;
+  }
+  if (buffer is BuiltinType) {
+    return withScratch((arena) {
+      final sizeInBytes = arena<Int64>();
+      final data = GDNativeInterface.packedArrayData(
+          buffer.nativePtr.cast(), buffer.typeInfo.variantType, sizeInBytes);
+      if (sizeInBytes.value >= 0) {
+        return WorkerBuffer(data.address, sizeInBytes.value);
+      }
+      throw ArgumentError.value(
+          buffer, 'buffer', 'Only packed arrays of plain data can be used');
+    });
+  }
+  throw ArgumentError.value(
+      buffer, 'buffer', 'Must be a WorkerBuffer or a packed array');
+}
+
+/// Called by the runtime on each new worker isolate. Returns the native port
+/// that jobs are sent to.
+@internal
+int startWorker(int workerIndex) {
+  final port = RawReceivePort(null, 'godot_dart_worker_$workerIndex');
+  port.handler = (Object? message) {
+    if (message is _WorkerRequest) {
+      _runRequest(message);
+    } else {
+      // The runtime is shutting down
+      port.close();
+    }
+  };
+  return port.sendPort.nativePort;
+}
+
+Future<void> _runRequest(_WorkerRequest request) async {
+  try {
+    final result = await request.job(request.buffers);
+    request.replyPort.send(_WorkerReply(request.id, result));
+  } catch (e, st) {
+    request.replyPort.send(
+        _WorkerReply.error(request.id, RemoteError(e.toString(), st.toString())));
+  }
+}
+
+/// Called by the runtime on a pool thread's helper isolate to run part of a
+/// [ThreadPoolTasks] task
+@internal
+void runThreadPoolTask(
+    Function task, int start, int end, WorkerBuffer buffer) {
+  if (task is void Function(int, int, WorkerBuffer)) {
+    task(start, end, buffer);
+  } else if (task is void Function(int, WorkerBuffer)) {
+    for (var i = start; i < end; ++i) {
+      task(i, buffer);
+    }
+  } else if (task is void Function(WorkerBuffer)) {
+    task(buffer);
+  }
+}
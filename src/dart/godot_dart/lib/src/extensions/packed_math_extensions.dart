@@ -0,0 +1,98 @@
+import 'dart:ffi';
+
+import '../core/core.dart';
+import '../gen/builtins.dart';
+import '../variant/variant.dart';
+
+// Bulk math on packed arrays, run natively (and vectorized) over the whole
+// array in one call. Prefer these to looping over elements in Dart, which
+// creates a Vector for every element.
+
+extension PackedVector2ArrayMath on PackedVector2Array {
+  /// Transform every point by [xform], in place.
+  void transformInPlace(Transform2D xform) {
+    GDNativeInterface.packedVector2Transform(
+        nativePtr.cast(), xform.nativePtr.cast());
+  }
+
+  /// Interpolate every point towards the point at the same index of [to],
+  /// in place. [to] must be the same size as this array.
+  void lerpInPlace(PackedVector2Array to, double weight) {
+    _lerpInPlace(this, to, weight);
+  }
+
+  /// Normalize every point, in place. Zero length points stay zero.
+  void normalizeInPlace() {
+    GDNativeInterface.packedVector2Normalize(nativePtr.cast());
+  }
+
+  /// The distance from each point to [point].
+  PackedFloat32Array distancesTo(Vector2 point) {
+    final distances = PackedFloat32Array();
+    withScratch((arena) {
+      final pointPtr = arena.allocate<Uint8>(Vector2.sTypeInfo.size);
+      point.copyTo(pointPtr);
+      GDNativeInterface.packedVector2DistanceTo(
+          nativePtr.cast(), pointPtr.cast(), distances.nativePtr.cast());
+    });
+    return distances;
+  }
+}
+
+extension PackedVector3ArrayMath on PackedVector3Array {
+  /// Transform every point by [xform], in place.
+  void transformInPlace(Transform3D xform) {
+    withScratch((arena) {
+      final xformPtr = arena.allocate<Uint8>(Transform3D.sTypeInfo.size);
+      xform.copyTo(xformPtr);
+      GDNativeInterface.packedVector3Transform(
+          nativePtr.cast(), xformPtr.cast());
+    });
+  }
+
+  /// Interpolate every point towards the point at the same index of [to],
+  /// in place. [to] must be the same size as this array.
+  void lerpInPlace(PackedVector3Array to, double weight) {
+    _lerpInPlace(this, to, weight);
+  }
+
+  /// Normalize every point, in place. Zero length points stay zero.
+  void normalizeInPlace() {
+    GDNativeInterface.packedVector3Normalize(nativePtr.cast());
+  }
+
+  /// The distance from each point to [point].
+  PackedFloat32Array distancesTo(Vector3 point) {
+    final distances = PackedFloat32Array();
+    withScratch((arena) {
+      final pointPtr = arena.allocate<Uint8>(Vector3.sTypeInfo.size);
+      point.copyTo(pointPtr);
+      GDNativeInterface.packedVector3DistanceTo(
+          nativePtr.cast(), pointPtr.cast(), distances.nativePtr.cast());
+    });
+    return distances;
+  }
+
+  /// The indices of the points inside [aabb], in order.
+  PackedInt32Array indicesInAabb(AABB aabb) {
+    final indices = PackedInt32Array();
+    GDNativeInterface.packedVector3CullAabb(
+        nativePtr.cast(), aabb.nativePtr.cast(), indices.nativePtr.cast());
+    return indices;
+  }
+}
+
+extension PackedFloat32ArrayMath on PackedFloat32Array {
+  /// Interpolate every value towards the value at the same index of [to],
+  /// in place. [to] must be the same size as this array.
+  void lerpInPlace(PackedFloat32Array to, double weight) {
+    _lerpInPlace(this, to, weight);
+  }
+}
+
+void _lerpInPlace(BuiltinType from, BuiltinType to, double weight) {
+  if (!GDNativeInterface.packedArrayLerp(from.nativePtr.cast(),
+      to.nativePtr.cast(), from.typeInfo.variantType, weight)) {
+    throw ArgumentError.value(to, 'to', 'Must be the same size');
+  }
+}
@@ -5,6 +5,8 @@
 /// Licensed under Apache 2.0
 ///
 import 'dart:developer';
+import 'dart:io';
+import 'dart:isolate';
 
 import 'package:vm_service/utils.dart';
 import 'package:vm_service/vm_service.dart' as vms;
@@ -36,14 +38,30 @@ Future<vms.VmService> createVmService() async {
 
 class HotReloader {
   late final vms.VmService _vmService;
+  final String? _isolateId;
+
+  // Modification time of every file backed script loaded in this isolate,
+  // used to work out which libraries a reload actually changed.
+  final _sourceTimestamps = <String, DateTime>{};
+  final _resolvedUris = <String, String?>{};
+  List<String>? _changedLibraries;
+
+  /// File paths of the libraries changed by the last reload. Part files are
+  /// reported as the library that owns them. `null` if the last reload
+  /// failed or the changes couldn't be determined.
+  List<String>? get changedLibraries => _changedLibraries;
 
   static Future<HotReloader?> create() async {
-    return HotReloader._(await createVmService());
+    final reloader = HotReloader._(await createVmService());
+    await reloader._findChangedLibraries();
+    return reloader;
   }
 
-  HotReloader._(this._vmService);
+  HotReloader._(this._vmService)
+      : _isolateId = Service.getIsolateId(Isolate.current);
 
   Future<HotReloadResult> reloadCode() async {
+    _changedLibraries = null;
     final reloadReports = <vms.IsolateRef, vms.ReloadReport>{};
     final failedReloadReports = <vms.IsolateRef, vms.ReloadReport>{};
     final stopwatch = Stopwatch();
@@ -73,6 +91,11 @@ class HotReloader {
         //     'Failed to reload code of isolate [${isolateRef.name}]: $ex');
       }
     }
+    final reloadedSelf = reloadReports.keys.any((e) => e.id == _isolateId) &&
+        !failedReloadReports.keys.any((e) => e.id == _isolateId);
+    if (reloadedSelf) {
+      _changedLibraries = await _findChangedLibraries();
+    }
     stopwatch.stop();
     print(
         '[godot_dart] Hot reload complete in ${stopwatch.elapsedMilliseconds}ms');
@@ -98,6 +121,69 @@ class HotReloader {
     return HotReloadResult.partiallySucceeded;
   }
 
+  // Compares the modification time of every script loaded in this isolate
+  // against the last time this was called, and returns the file paths of the
+  // libraries that own any script that changed or was added.
+  Future<List<String>?> _findChangedLibraries() async {
+    final isolateId = _isolateId;
+    if (isolateId == null) return null;
+
+    try {
+      final changedScripts = <vms.ScriptRef>[];
+      final scriptList = await _vmService.getScripts(isolateId);
+      for (final scriptRef in scriptList.scripts ?? <vms.ScriptRef>[]) {
+        final path = await _resolveFilePath(scriptRef.uri);
+        if (path == null) continue;
+
+        final stat = FileStat.statSync(path);
+        if (stat.type == FileSystemEntityType.notFound) {
+          _sourceTimestamps.remove(path);
+          continue;
+        }
+        if (_sourceTimestamps[path] != stat.modified) {
+          _sourceTimestamps[path] = stat.modified;
+          changedScripts.add(scriptRef);
+        }
+      }
+
+      // Only look up the owning library for scripts that changed, so this
+      // scales with the size of the edit rather than the size of the project
+      final changedLibraries = <String>{};
+      for (final scriptRef in changedScripts) {
+        final script =
+            await _vmService.getObject(isolateId, scriptRef.id!) as vms.Script;
+        final libraryPath = await _resolveFilePath(script.library?.uri);
+        if (libraryPath != null) {
+          changedLibraries.add(libraryPath);
+        }
+      }
+      return changedLibraries.toList();
+    } on vms.RPCError catch (e) {
+      print('[godot_dart] Failed to determine changed libraries: $e');
+    } on vms.SentinelException {
+      // Isolate is going away
+    }
+    return null;
+  }
+
+  Future<String?> _resolveFilePath(String? uriString) async {
+    if (uriString == null) return null;
+    if (_resolvedUris.containsKey(uriString)) {
+      return _resolvedUris[uriString];
+    }
+
+    String? path;
+    var uri = Uri.parse(uriString);
+    if (uri.isScheme('package')) {
+      uri = await Isolate.resolvePackageUri(uri) ?? uri;
+    }
+    if (uri.isScheme('file')) {
+      path = uri.toFilePath();
+    }
+    _resolvedUris[uriString] = path;
+    return path;
+  }
+
   Future<void> stop() async {
     // to prevent "Unhandled exception: reloadSources: (-32000) Service connection disposed"
     await Future<void>.delayed(const Duration(seconds: 2));
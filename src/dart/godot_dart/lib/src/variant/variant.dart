@@ -221,7 +221,8 @@ class Variant implements Finalizable {
   @pragma('vm:entry-point')
   TypeInfo get typeInfo => sTypeInfo;
 
-  final Pointer<Uint8> _opaque = gde.ffiBindings.gde_mem_alloc(_size).cast();
+  // Recycled by finalizeVariant
+  final Pointer<Uint8> _opaque = GDNativeInterface.variantPoolAlloc().cast();
 
   Pointer<Uint8> get nativePtr => _opaque;
   @pragma('vm:entry-point')
@@ -72,6 +72,7 @@ class GodotScriptAnnotationGenerator
     }
 
     final isGlobalClassReader = annotation.read('isGlobal');
+    final iconReader = annotation.read('icon');
 
     buffer.writeln(
         'ExtensionTypeInfo<${element.name}> _\$${element.name}TypeInfo() {');
@@ -88,6 +89,9 @@ class GodotScriptAnnotationGenerator
     buffer.writeln('    isScript: true,');
     buffer.writeln(
         '    isGlobalClass: ${isGlobalClassReader.isNull ? 'false' : isGlobalClassReader.boolValue},');
+    if (iconReader.isString) {
+      buffer.writeln('    iconPath: \'${iconReader.stringValue}\',');
+    }
     buffer.writeln('  );');
 
     List<FieldElement> signalFields = [];
@@ -108,6 +108,7 @@ Future<void> generateUtilityFunctions(
   o.nl();
   o.p("import '../core/gdextension_ffi_bindings.dart';");
   o.p("import '../core/gdextension.dart';");
+  o.p("import '../core/scratch_allocator.dart';");
   o.p("import '../variant/variant.dart';");
   o.p("import 'engine_classes.dart';");
   o.p("import 'builtins.dart';");
@@ -124,7 +125,7 @@ Future<void> generateUtilityFunctions(
             ArgumentProxy.fromReturnType(utilityFunction.returnType);
         final hasReturn = returnInfo.typeCategory != TypeCategory.voidType;
         final retString = hasReturn ? 'return ' : '';
-        o.b('${retString}using((arena) {', () {
+        o.b('${retString}withScratch((arena) {', () {
           final argumentsVar = createPtrcallArguments(o, arguments);
 
           if (hasReturn) {
@@ -172,7 +172,7 @@ void withAllocationBlock(
     final hasReturn =
         retInfo != null && retInfo.typeCategory != TypeCategory.voidType;
     final retString = hasReturn ? 'return ' : '';
-    out.b('${retString}using((arena) {', () {
+    out.b('${retString}withScratch((arena) {', () {
       writeBlock();
     }, '});');
   } else {
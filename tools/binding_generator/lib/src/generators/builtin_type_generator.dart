@@ -301,7 +301,7 @@ void _writeMembers(CodeSink o, BuiltinClass builtin) {
   for (final member in members) {
     final memberProxy = member.proxy;
     o.b('${memberProxy.dartType} get ${member.name} {', () {
-      o.b('return using((arena) {', () {
+      o.b('return withScratch((arena) {', () {
         writeReturnAllocation(memberProxy, o);
         o.p('final f = _bindings.member${member.name.toUpperCamelCase()}Getter!.asFunction<void Function(GDExtensionConstTypePtr, GDExtensionTypePtr)>(isLeaf: true);');
         o.p('f(nativePtr.cast(), retPtr.cast());');
@@ -430,7 +430,7 @@ void _generatePtrcallMethod(CodeSink o, BuiltinClassMethod method) {
   final hasReturn = returnInfo.typeCategory != TypeCategory.voidType;
   final retString = hasReturn ? 'return ' : '';
 
-  o.b('${retString}using((arena) {', () {
+  o.b('${retString}withScratch((arena) {', () {
     final argumentsVar = createPtrcallArguments(o, arguments);
 
     if (hasReturn) {
@@ -276,6 +276,11 @@ void _writeMethods(CodeSink o, GodotExtensionApiJsonClass classInfo) {
       _generatePtrcallMethod(o, method);
     }, '}');
     o.nl();
+
+    if (_canBatch(classInfo, method)) {
+      _generatePtrcallBatchMethod(o, classInfo, method);
+      o.nl();
+    }
   }
 }
 
@@ -319,7 +324,7 @@ void _generatePtrcallMethod(CodeSink o, ClassMethod method) {
       returnInfo != null && returnInfo.typeCategory != TypeCategory.voidType;
   final retString = hasReturn ? 'return ' : '';
 
-  o.b('${retString}using((arena) {', () {
+  o.b('${retString}withScratch((arena) {', () {
     final argumentsVar = createPtrcallArguments(o, arguments);
 
     if (hasReturn) {
@@ -335,6 +340,161 @@ void _generatePtrcallMethod(CodeSink o, ClassMethod method) {
   }, '});');
 }
 
+// Methods that get a static `<method>Batch` variant, by class. Batching is
+// for methods commonly called on many objects each frame, generating it for
+// every method would double the size of the bindings.
+const _batchMethods = <String, Set<String>>{
+  'Node': {'queue_free', 'set_process', 'set_physics_process'},
+  'CanvasItem': {
+    'set_visible',
+    'set_modulate',
+    'set_self_modulate',
+    'set_z_index',
+    'queue_redraw',
+  },
+  'Node2D': {
+    'set_position',
+    'get_position',
+    'set_rotation',
+    'get_rotation',
+    'set_scale',
+    'get_scale',
+    'set_global_position',
+    'get_global_position',
+    'rotate',
+    'translate',
+    'look_at',
+  },
+  'Node3D': {
+    'set_position',
+    'get_position',
+    'set_rotation',
+    'get_rotation',
+    'set_scale',
+    'get_scale',
+    'set_transform',
+    'get_transform',
+    'set_global_position',
+    'get_global_position',
+    'set_global_transform',
+    'get_global_transform',
+    'set_visible',
+    'rotate_y',
+    'translate',
+    'look_at',
+  },
+  'Sprite2D': {'set_frame', 'set_flip_h'},
+  'CharacterBody2D': {'set_velocity', 'get_velocity', 'move_and_slide'},
+  'CharacterBody3D': {'set_velocity', 'get_velocity', 'move_and_slide'},
+  'RigidBody2D': {'set_linear_velocity', 'apply_central_impulse'},
+  'RigidBody3D': {'set_linear_velocity', 'apply_central_impulse'},
+};
+
+bool _canBatch(GodotExtensionApiJsonClass classInfo, ClassMethod method) {
+  if (method.isVirtual || method.isVararg || method.isStatic) {
+    return false;
+  }
+  if (!(_batchMethods[classInfo.name]?.contains(method.name) ?? false)) {
+    return false;
+  }
+  // Don't collide with a real method that happens to end in _batch
+  final batchName = '${method.name}_batch';
+  return !(classInfo.methods?.any((m) => m.name == batchName) ?? false);
+}
+
+/// Writes a static `<method>Batch` variant, which calls the method on every
+/// object in a list with a single call into native code. Arguments are given
+/// as lists with one value per object.
+///
+/// Return slots come from the scratch allocator, which zeroes them, as Godot
+/// assigns into them and would otherwise release garbage for `Ref` and
+/// `TypedArray` returns.
+void _generatePtrcallBatchMethod(
+    CodeSink o, GodotExtensionApiJsonClass classInfo, ClassMethod method) {
+  final methodName = escapeMethodName(method.name);
+  final dartMethodName = getDartMethodName(method.name, false);
+  final arguments = method.arguments?.map((e) => e.proxy).toList() ?? [];
+  final returnInfo = method.returnValue?.proxy;
+  final hasReturn =
+      returnInfo != null && returnInfo.typeCategory != TypeCategory.voidType;
+  final returnType = hasReturn ? 'List<${returnInfo.dartType}>' : 'void';
+
+  final parameters = [
+    'List<${classInfo.dartName}> objects',
+    for (final argument in arguments)
+      'List<${argument.dartType}> ${escapeName(argument.name).toLowerCamelCase()}Values',
+  ];
+  o.b('static $returnType ${dartMethodName}Batch(${parameters.join(', ')}) {',
+      () {
+    o.p('final batchCount = objects.length;');
+    for (final argument in arguments) {
+      final valuesName = '${escapeName(argument.name).toLowerCamelCase()}Values';
+      o.b('if ($valuesName.length != batchCount) {', () {
+        o.p("throw ArgumentError.value($valuesName, '$valuesName', 'Must have one value per object');");
+      }, '}');
+    }
+
+    o.b('${hasReturn ? 'return ' : ''}withScratch((arena) {', () {
+      o.p('final batchInstances = arena.allocate<GDExtensionObjectPtr>(sizeOf<GDExtensionObjectPtr>() * batchCount);');
+      o.b('for (var batchIndex = 0; batchIndex < batchCount; ++batchIndex) {',
+          () {
+        o.p('batchInstances[batchIndex] = objects[batchIndex].nativePtr.cast();');
+      }, '}');
+
+      final stride = arguments.length;
+      if (stride > 0) {
+        o.p('final batchArgs = arena.allocate<GDExtensionConstTypePtr>(sizeOf<GDExtensionConstTypePtr>() * batchCount * $stride);');
+      } else {
+        o.p('Pointer<GDExtensionConstTypePtr> batchArgs = nullptr;');
+      }
+      final needsKeepAlive = arguments
+          .any((a) => a.type == 'String' || a.type == 'StringName');
+      if (needsKeepAlive) {
+        // The converted strings have to outlive the loop iteration that
+        // creates them
+        o.p('final batchKeepAlive = <Object>[];');
+      }
+      if (hasReturn) {
+        o.p('final batchRets = arena.allocate<GDExtensionTypePtr>(sizeOf<GDExtensionTypePtr>() * batchCount);');
+        o.p('final batchReaders = <${returnInfo.dartType} Function()>[];');
+      }
+
+      if (stride > 0 || hasReturn) {
+        o.b('for (var batchIndex = 0; batchIndex < batchCount; ++batchIndex) {',
+            () {
+          arguments.forEachIndexed((i, argument) {
+            final varName = escapeName(argument.name).toLowerCamelCase();
+            // Matches the nullability of the regular method's parameter, which
+            // the conversion relies on
+            final nullable = argument.defaultArgumentValue != null &&
+                !argument.isOptional &&
+                !isPrimitiveType(argument.dartType);
+            o.p('final ${argument.dartType}${nullable ? '?' : ''} $varName = ${varName}Values[batchIndex];');
+            convertDartToPtrArgument(
+                '(batchArgs + batchIndex * $stride + $i)', argument, o);
+            if (argument.type == 'String' || argument.type == 'StringName') {
+              o.p('batchKeepAlive.add(gd$varName);');
+            }
+          });
+          if (hasReturn) {
+            writeReturnAllocation(returnInfo, o);
+            o.p('batchRets[batchIndex] = retPtr.cast();');
+            o.b('batchReaders.add(() {', () {
+              writeReturnRead(returnInfo, o);
+            }, '});');
+          }
+        }, '}');
+      }
+
+      o.p('gde.ffiBindings.gde_object_method_bind_ptrcall_batch(');
+      o.p('  _bindings.method${methodName.toUpperCamelCase()}, batchInstances, batchCount, batchArgs, $stride, ${hasReturn ? 'batchRets' : 'nullptr'});');
+      if (hasReturn) {
+        o.p('return [for (final read in batchReaders) read()];');
+      }
+    }, '});');
+  }, '}');
+}
+
 void _writeBindingsClass(CodeSink o, GodotExtensionApiJsonClass classInfo) {
   o.b('class _${classInfo.name}Bindings {', () {
     final methods = classInfo.methods ?? [];
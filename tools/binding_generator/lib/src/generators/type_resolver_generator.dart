@@ -25,5 +25,23 @@ Future<void> generateTypeResolver(GodotApiInfo api, String targetDir) async {
         o.p('addType(${classInfo.dartName}.sTypeInfo);');
       }
     }, '}');
+    o.nl();
+
+    // Registers factories instead of type infos, so engine classes are only
+    // initialized the first time they're looked up
+    o.b('void addGodotStandardLibraryLazy() {', () {
+      o.b('addLazyTypes(', () {
+        o.b('{', () {
+          for (final classInfo in api.engineClasses.values) {
+            o.p("'${classInfo.name}': () => ${classInfo.dartName}.sTypeInfo,");
+          }
+        }, '},');
+        o.b('{', () {
+          for (final classInfo in api.engineClasses.values) {
+            o.p('${classInfo.dartName}: () => ${classInfo.dartName}.sTypeInfo,');
+          }
+        }, '},');
+      }, ');');
+    }, '}');
   }, '}');
 }